@@ -37,11 +37,13 @@ name in the same namespace. ->YOMM2_SYMBOL can be used for that effect.
 
 ## Member functions
 
-| Name                         | Description                        |
-| ---------------------------- | ---------------------------------- |
-| [constructor](#constructor)  | construct and register the method  |
-| [destructor](#destructor)    | destruct and unregister the method |
-| [operator()](#call-operator) | call the method                    |
+| Name                         | Description                                  |
+| ---------------------------- | -------------------------------------------- |
+| [constructor](#constructor)  | construct and register the method            |
+| [destructor](#destructor)    | destruct and unregister the method           |
+| [operator()](#call-operator) | call the method                              |
+| [cell_of](#cell_of)          | index of the dispatch cell for the arguments |
+| [target_of](#target_of)      | function in a dispatch cell                  |
 
 ## constructor
 
@@ -64,6 +66,27 @@ method<Key, R(Args...)>::operator()(args...);
 Call the method. The dynamic types of the arguments corresponding to a
 ->virtual_ parameter determine which method definition to call.
 
+## cell_of
+```c++
+std::size_t method<Key, R(Args...)>::cell_of(args...) const;
+```
+Return the index of the cell, in the dispatch table of a multi-method, that the
+arguments select. Arguments whose dynamic types are in the same group - i.e.
+for which the same definitions are applicable - select the same cell. The index
+is a stable identifier for the dispatch decision, until the next call to
+->`update`; it can be used to sort, batch or memoize calls. It is the same in
+all the overlays (see ->`overlay_scope`).
+
+## target_of
+```c++
+function_pointer_type method<Key, R(Args...)>::target_of(std::size_t cell) const;
+```
+Return the function stored in `cell` - i.e. the function that the method calls,
+if `cell` is the value returned by `cell_of` for the arguments.
+
+`cell_of` and `target_of` are available for multi-methods only. For uni-methods,
+use `resolve`.
+
 ## Static member variable
 
 | Name      | Description                        |
@@ -73,6 +73,7 @@ have been set up.
 | -------------------- | ----------------------------------------- |
 | ->policy-vptr_map    | store the vptrs in a `std::unordered_map` |
 | ->policy-vptr_vector | store the vptrs in a `std::vector`        |
+| ->policy-vptr_pages  | find the vptr in the page of the object   |
 
 ## Example
 
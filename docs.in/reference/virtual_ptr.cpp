@@ -9,6 +9,8 @@
 entry: virtual_ptr
 entry: virtual_shared_ptr
 entry: make_virtual_shared
+entry: virtual_unique_ptr
+entry: make_virtual_unique
 hrefs: virtual_ptr-final
 headers: yorel/yomm2/core.hpp, yorel/yomm2/keywords.hpp, yorel/yomm2.hpp
 
@@ -49,6 +51,14 @@ object.
 Virtual shared pointers should be passed by const reference, to avoid excessive
 manipulations of the reference count.
 
+```
+template<class Class, class Policy = default_policy>
+class virtual_ptr<std::unique_ptr<Class>>;
+```
+
+This specialization uses the standard `unique_ptr` to own the object. It is
+move-only, and `get` returns a plain pointer.
+
 ## Member functions
 
 |                               |                              |
@@ -77,12 +87,14 @@ manipulations of the reference count.
 |                                                                  |                                                 |
 | ---------------------------------------------------------------- | ----------------------------------------------- |
 | [template@<class Class> virtual_shared_ptr](#virtual_shared_ptr) | alias for `virtual_ptr<std::shared_ptr<Class>>` |
+| [template@<class Class> virtual_unique_ptr](#virtual_unique_ptr) | alias for `virtual_ptr<std::unique_ptr<Class>>` |
 
 ## Non member functions
 
 |                                                                      |                                                 |
 | -------------------------------------------------------------------- | ----------------------------------------------- |
 | [template@<class Class> make_virtual_shared()](#make_virtual_shared) | creates an object and returns a new virtual_ptr |
+| [template@<class Class> make_virtual_unique(args...)](#make_virtual_unique) | creates an object and returns a new virtual_ptr |
 
 ## virtual_ptr
 
@@ -165,6 +177,20 @@ it. No hash table lookup is performed.
 
 This construct is always safe to use, even with non-polymorphic types.
 
+## virtual_unique_ptr
+
+`virtual_unique_ptr<Class>` is an alias for
+`virtual_ptr<std::unique_ptr<Class>>`.
+
+## make_virtual_unique
+
+|                                                                            |     |
+| -------------------------------------------------------------------------- | --- |
+| `template@<class Class, class Policy, typename... T$gt; make_virtual_unique(T&&... args)` |     |
+
+Constructs an object, using `std::make_unique`, and return a `virtual_ptr` to
+it. No hash table lookup is performed.
+
 # Discussion
 
 Calls to methods through a `virtual_ptr` are almost as efficient as virtual
@@ -544,3 +570,68 @@ BOOST_AUTO_TEST_CASE(ref_make_virtual_shared) {
     the name for the time when C++ supports a user-defined dot operator.
 
 ***/
+
+/***
+
+# Virtual unique pointers
+
+The `virtual_ptr<std::unique_ptr<Class>>` specialisation owns the object, like
+`std::unique_ptr`, without the atomic reference counting of `shared_ptr`.
+
+`virtual_unique_ptr<Class>` is an alias for
+`virtual_ptr<std::unique_ptr<Class>>`.
+
+Virtual unique pointers are not passed to methods directly. Instead, methods
+take plain `virtual_ptr` parameters, and a `virtual_unique_ptr` converts to a
+`virtual_ptr` that borrows the object, and reuses its method table pointer.
+Ownership is not transferred. Only lvalues can be borrowed from: converting a
+temporary owning `virtual_ptr` - e.g. the result of `make_virtual_unique` - to
+a plain `virtual_ptr` would leave it dangling, and does not compile.
+
+## Example
+
+***/
+
+namespace YOMM2_GENSYM {
+
+//***
+
+class Animal {
+};
+
+class Dog : public Animal {
+};
+
+class Cat : public Animal {
+};
+
+register_classes(Animal, Dog, Cat);
+
+using yorel::yomm2::virtual_ptr;
+using yorel::yomm2::virtual_unique_ptr;
+
+declare_method(std::string, sound, (virtual_ptr<Animal>));
+
+define_method(std::string, sound, (virtual_ptr<Dog>)) {
+    return "bark";
+}
+
+define_method(std::string, sound, (virtual_ptr<Cat>)) {
+    return "meow";
+}
+
+BOOST_AUTO_TEST_CASE(ref_make_virtual_unique) {
+    yorel::yomm2::update();
+
+    using yorel::yomm2::make_virtual_unique;
+
+    std::vector<virtual_unique_ptr<Animal>> animals;
+    animals.push_back(make_virtual_unique<Dog>());
+    animals.push_back(make_virtual_unique<Cat>());
+
+    BOOST_TEST(sound(animals[0]) == "bark");
+    BOOST_TEST(sound(animals[1]) == "meow");
+}
+
+//***
+}
@@ -10,15 +10,24 @@ int main(int argc, char* argv[]) {
     auto compiler = update();
     generator generator;
 
-    std::ofstream slots("slots.hpp");
+    generator::output_file slots("slots.hpp");
     generator
         .write_static_offsets<method_class(void, kick, (virtual_ptr<Animal>))>(
             slots)
         .write_static_offsets<method_class(
             void, meet, (virtual_ptr<Animal>, virtual_ptr<Animal>))>(slots);
 
-    std::ofstream tables("tables.hpp");
+    generator::output_file tables("tables.hpp");
     generator.encode_dispatch_data(compiler, tables);
 
+    for (auto file : {&slots, &tables}) {
+        file->close();
+        std::cout << file->path << ": "
+                  << (file->written ? "written" : "unchanged") << " in "
+                  << std::chrono::duration<double, std::milli>(file->elapsed)
+                         .count()
+                  << " ms\n";
+    }
+
     return 0;
 }
@@ -0,0 +1,115 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Select the fastest policy for a hierarchy and a sample of calls.
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <yorel/yomm2/keywords.hpp>
+#include <yorel/yomm2/tuning.hpp>
+
+using namespace yorel::yomm2;
+
+struct Shape {
+    virtual ~Shape() {
+    }
+};
+
+struct Circle : Shape {};
+struct Square : Shape {};
+struct Triangle : Shape {};
+struct Hexagon : Shape {};
+
+template<class Policy>
+struct intersect_;
+
+template<class Policy>
+using intersect = method<
+    intersect_<Policy>,
+    int(virtual_ptr<Shape, Policy>, virtual_ptr<Shape, Policy>), Policy>;
+
+template<class Policy>
+struct area_;
+
+template<class Policy>
+using area = method<area_<Policy>, int(virtual_<const Shape&>), Policy>;
+
+template<class Policy>
+struct shapes_workload {
+    // Register the classes and the definitions in 'Policy'.
+    static inline use_classes<Shape, Circle, Square, Triangle, Hexagon, Policy>
+        classes;
+
+    template<class A, class B>
+    static int intersect_shapes(
+        virtual_ptr<A, Policy>, virtual_ptr<B, Policy>) {
+        return sizeof(A) + sizeof(B);
+    }
+
+    static inline typename intersect<Policy>::template add_functions<
+        intersect_shapes<Shape, Shape>, intersect_shapes<Circle, Square>,
+        intersect_shapes<Square, Circle>, intersect_shapes<Circle, Circle>>
+        intersect_definitions;
+
+    template<class Class>
+    static int area_shape(const Class&) {
+        return sizeof(Class);
+    }
+
+    static inline typename area<Policy>::template add_functions<
+        area_shape<Shape>, area_shape<Circle>, area_shape<Square>,
+        area_shape<Triangle>>
+        area_definitions;
+
+    // A sample of the program's calls.
+    std::vector<std::unique_ptr<Shape>> objects;
+    std::vector<std::pair<Shape*, Shape*>> trace;
+
+    shapes_workload() {
+        // odr-use the static members, so they are instantiated
+        (void)&classes;
+        (void)&intersect_definitions;
+        (void)&area_definitions;
+
+        objects.push_back(std::make_unique<Circle>());
+        objects.push_back(std::make_unique<Square>());
+        objects.push_back(std::make_unique<Triangle>());
+        objects.push_back(std::make_unique<Hexagon>());
+
+        std::default_random_engine rnd;
+        std::uniform_int_distribution<std::size_t> dist(0, objects.size() - 1);
+
+        for (int i = 0; i < 10000; ++i) {
+            trace.emplace_back(
+                objects[dist(rnd)].get(), objects[dist(rnd)].get());
+        }
+    }
+
+    std::size_t operator()() {
+        int sum = 0;
+
+        for (auto [a, b] : trace) {
+            sum += area<Policy>::fn(*a);
+            sum += intersect<Policy>::fn(
+                virtual_ptr<Shape, Policy>(*a),
+                virtual_ptr<Shape, Policy>(*b));
+        }
+
+        volatile int result = sum;
+        (void)result;
+
+        return 2 * trace.size();
+    }
+};
+
+int main() {
+    auto results = tuning::tune<shapes_workload>();
+    tuning::print(std::cout, results, "shapes_policy");
+
+    return 0;
+}
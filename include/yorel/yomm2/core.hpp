@@ -1,8 +1,12 @@
 #ifndef YOREL_YOMM2_CORE_HPP
 #define YOREL_YOMM2_CORE_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <new>
 
 #include <boost/assert.hpp>
 
@@ -77,6 +81,8 @@ struct method<Key, R(A...), Policy> : detail::method_info {
     template<typename ArgType>
     const std::uintptr_t* vptr(const ArgType& arg) const;
 
+    const std::size_t* slots_strides_data() const;
+
     template<class Error>
     void check_static_offset(std::size_t actual, std::size_t expected) const;
 
@@ -84,22 +90,35 @@ struct method<Key, R(A...), Policy> : detail::method_info {
     std::uintptr_t
     resolve_uni(const ArgType& arg, const MoreArgTypes&... more_args) const;
 
+    // Return the address of the cell in the dispatch table.
     template<typename MethodArgList, typename ArgType, typename... MoreArgTypes>
-    std::uintptr_t resolve_multi_first(
+    const std::uintptr_t* resolve_multi_first(
         const ArgType& arg, const MoreArgTypes&... more_args) const;
 
     template<
         std::size_t VirtualArg, typename MethodArgList, typename ArgType,
         typename... MoreArgTypes>
-    std::uintptr_t resolve_multi_next(
+    const std::uintptr_t* resolve_multi_next(
         const std::uintptr_t* dispatch, const ArgType& arg,
         const MoreArgTypes&... more_args) const;
 
+    template<
+        std::size_t VirtualArg, typename MethodArgList, typename ArgType,
+        typename... MoreArgTypes>
+    std::uintptr_t resolve_decisive(
+        std::size_t vp, const ArgType& arg,
+        const MoreArgTypes&... more_args) const;
+
     template<typename... ArgType>
     function_pointer_type resolve(const ArgType&... args) const;
 
     return_type operator()(detail::remove_virtual<A>... args) const;
 
+    // Dispatch coordinates, for multi-methods: the index of the cell of the
+    // dispatch table that the arguments select, and the function in a cell.
+    std::size_t cell_of(detail::remove_virtual<A>... args) const;
+    function_pointer_type target_of(std::size_t cell) const;
+
     static BOOST_NORETURN return_type
     not_implemented_handler(detail::remove_virtual<A>... args);
     static BOOST_NORETURN return_type
@@ -108,7 +127,7 @@ struct method<Key, R(A...), Policy> : detail::method_info {
     template<typename Container>
     using next = detail::next_aux<method, Container>;
 
-    template<auto Function>
+    template<auto Function, class Overlay = void>
     struct add_function {
         explicit add_function(next_type* next = nullptr) {
 
@@ -124,14 +143,22 @@ struct method<Key, R(A...), Policy> : detail::method_info {
             info.next = reinterpret_cast<void**>(next);
             using parameter_types =
                 detail::parameter_type_list_t<decltype(Function)>;
-            info.pf = (void*)detail::thunk<
-                Policy, signature_type, Function, parameter_types>::fn;
+            info.pf = detail::thunk<
+                Policy, signature_type, Function, parameter_types>::address();
             using spec_type_ids = detail::type_id_list<
                 Policy,
                 detail::spec_polymorphic_types<
                     Policy, declared_argument_types, parameter_types>>;
             info.vp_begin = spec_type_ids::begin;
             info.vp_end = spec_type_ids::end;
+
+            if constexpr (!std::is_same_v<Overlay, void>) {
+                static_assert(
+                    Policy::template has_facet<policy::overlay>,
+                    "overlays require a policy with an overlay facet");
+                info.overlay = Policy::template static_type<Overlay>();
+            }
+
             fn.specs.push_back(info);
         }
     };
@@ -139,6 +166,15 @@ struct method<Key, R(A...), Policy> : detail::method_info {
     template<auto... Function>
     struct add_functions : std::tuple<add_function<Function>...> {};
 
+    template<class Overlay, auto Function>
+    struct add_overlay_function : add_function<Function, Overlay> {
+        using add_function<Function, Overlay>::add_function;
+    };
+
+    template<class Overlay, auto... Function>
+    struct add_overlay_functions
+        : std::tuple<add_function<Function, Overlay>...> {};
+
     template<typename Container, bool has_next>
     struct add_definition_;
 
@@ -167,6 +203,66 @@ struct method<Key, R(A...), Policy> : detail::method_info {
         std::tuple<add_member_function<F>...> add;
     };
 
+    // Returns a function with the signature of the method, that calls
+    // 'Function' - or 'Function' itself, if it has exactly the type of the
+    // method. For use by the loaders of deferred definitions.
+    template<auto Function>
+    static function_pointer_type thunk() {
+        return reinterpret_cast<function_pointer_type>(
+            detail::thunk<
+                Policy, signature_type, Function,
+                detail::parameter_type_list_t<decltype(Function)>>::address());
+    }
+
+    template<typename Signature, auto Loader>
+    struct add_deferred_function {
+        static inline detail::definition_info info;
+        static inline std::once_flag loaded;
+        static inline function_pointer_type function;
+
+        add_deferred_function() {
+            if (info.method) {
+                BOOST_ASSERT(info.method == &fn);
+                return;
+            }
+
+            info.method = &fn;
+            info.type = Policy::template static_type<add_deferred_function>();
+            info.next = nullptr;
+            info.pf = (void*)stub;
+            using spec_type_ids = detail::type_id_list<
+                Policy,
+                detail::spec_polymorphic_types<
+                    Policy, declared_argument_types,
+                    detail::parameter_type_list_t<Signature>>>;
+            info.vp_begin = spec_type_ids::begin;
+            info.vp_end = spec_type_ids::end;
+            fn.specs.push_back(info);
+        }
+
+        // Placed in the dispatch tables and 'next' pointers by update(). On
+        // the first call, loads the definition; always forwards the call to
+        // it. The dispatch data is not patched, because other threads may be
+        // reading it: the loaded function is installed directly by the next
+        // update().
+        static return_type stub(detail::remove_virtual<A>... args) {
+            std::call_once(loaded, [] {
+                function = Loader();
+
+                if (function) {
+                    info.pf = (void*)function;
+                }
+            });
+
+            if (!function) {
+                not_implemented_handler(
+                    std::forward<detail::remove_virtual<A>>(args)...);
+            }
+
+            return function(std::forward<detail::remove_virtual<A>>(args)...);
+        }
+    };
+
     template<typename Container>
     struct use_next {
         static next_type next;
@@ -217,9 +313,14 @@ class virtual_ptr {
     using Box = std::conditional_t<IsSmartPtr, Class, Class*>;
     static constexpr bool is_indirect =
         Policy::template has_facet<policy::indirect_vptr>;
+    static constexpr bool is_generation_checked =
+        Policy::template has_facet<policy::generation_vptr>;
 
     using vptr_type = std::conditional_t<
-        is_indirect, std::uintptr_t const* const*, std::uintptr_t const*>;
+        is_generation_checked, detail::generation_checked_vptr<Policy>,
+        std::conditional_t<
+            is_indirect, std::uintptr_t const* const*,
+            std::uintptr_t const*>>;
 
     Box obj;
     vptr_type vptr;
@@ -227,11 +328,8 @@ class virtual_ptr {
     template<typename Other>
     void box(Other&& value) {
         if constexpr (IsSmartPtr) {
-            if constexpr (std::is_rvalue_reference_v<Other>) {
-                obj = std::move(value);
-            } else {
-                obj = value;
-            }
+            // move from rvalues, copy from lvalues
+            obj = std::forward<Other>(value);
         } else {
             static_assert(std::is_lvalue_reference_v<Other>);
             obj = &value;
@@ -246,35 +344,58 @@ class virtual_ptr {
         }
     }
 
+    // Whether converting from a virtual_ptr<Other> borrows the object from a
+    // smart pointer.
+    template<class Other>
+    static constexpr bool borrows_from =
+        !IsSmartPtr && virtual_ptr<Other, Policy>::IsSmartPtr;
+
+    template<class OtherBox>
+    static decltype(auto) rebox(OtherBox&& other) {
+        if constexpr (
+            !IsSmartPtr &&
+            !std::is_pointer_v<std::remove_reference_t<OtherBox>>) {
+            // borrow the object from a smart pointer
+            return other.get();
+        } else {
+            return std::forward<OtherBox>(other);
+        }
+    }
+
   public:
     using element_type = Class;
     using box_type = Box;
 
     template<class Other>
     virtual_ptr(Other&& other) {
-        box(other);
-
         using namespace policy;
         using namespace detail;
 
+        using other_virtual_traits =
+            virtual_traits<Policy, const std::remove_reference_t<Other>&>;
+        using polymorphic_type =
+            typename other_virtual_traits::polymorphic_type;
+
         static_assert(
-            std::is_polymorphic_v<polymorphic_type<
-                Policy, const std::remove_reference_t<Other>&>>,
-            "use 'final' if intended");
+            std::is_polymorphic_v<polymorphic_type>, "use 'final' if intended");
 
         auto dynamic_id =
-            Policy::dynamic_type(virtual_traits<Policy, Other&>::rarg(other));
-        auto static_id = Policy::template static_type<
-            typename virtual_traits<Policy, Other&>::polymorphic_type>();
-
-        if (dynamic_id == static_id) {
+            Policy::dynamic_type(other_virtual_traits::rarg(other));
+        auto static_id = Policy::template static_type<polymorphic_type>();
+
+        if constexpr (has_facet<Policy, nearest_base>) {
+            static_assert(
+                !has_facet<Policy, indirect_vptr>,
+                "vptr_nearest_base cannot be combined with indirect_vptr");
+            // neither class needs to be registered; only bases of 'Class'
+            // qualify
+            vptr = Policy::type_vptr(
+                dynamic_id, Policy::template static_type<Class>());
+        } else if (dynamic_id == static_id) {
             if constexpr (has_facet<Policy, indirect_vptr>) {
-                vptr = &Policy::template static_vptr<
-                    typename detail::virtual_traits<
-                        Policy, Other&>::polymorphic_type>;
+                vptr = &Policy::template static_vptr<polymorphic_type>;
             } else {
-                vptr = Policy::template static_vptr<
-                    typename virtual_traits<Policy, Other&>::polymorphic_type>;
+                vptr = Policy::template static_vptr<polymorphic_type>;
             }
         } else {
             auto index = dynamic_id;
@@ -289,25 +410,45 @@ class virtual_ptr {
                 vptr = Policy::vptrs[index];
             }
         }
+
+        box(std::forward<Other>(other));
     }
 
     template<class Other>
     virtual_ptr(virtual_ptr<Other, Policy>& other)
-        : obj(other.obj), vptr(other.vptr) {
+        : obj(rebox(other.obj)), vptr(other.vptr) {
     }
 
     template<class Other>
     virtual_ptr(const virtual_ptr<Other, Policy>& other)
-        : obj(other.obj), vptr(other.vptr) {
+        : obj(rebox(other.obj)), vptr(other.vptr) {
     }
 
-    template<class Other>
+    template<
+        class Other, typename = std::enable_if_t<!borrows_from<Other>>>
     virtual_ptr(virtual_ptr<Other, Policy>&& other)
-        : obj(std::move(other.obj)), vptr(other.vptr) {
+        : obj(rebox(std::move(other.obj))), vptr(other.vptr) {
     }
 
+    // Borrowing from a temporary that owns the object would leave a dangling
+    // pointer.
+    template<
+        class Other, typename = std::enable_if_t<borrows_from<Other>>,
+        typename = void>
+    virtual_ptr(virtual_ptr<Other, Policy>&& other) = delete;
+
+    template<
+        class Other, typename = std::enable_if_t<borrows_from<Other>>,
+        typename = void>
+    virtual_ptr(const virtual_ptr<Other, Policy>&& other) = delete;
+
     auto get() const noexcept {
-        return obj;
+        if constexpr (std::is_copy_constructible_v<Box>) {
+            return obj;
+        } else {
+            // unique_ptr: keep the ownership
+            return obj.get();
+        }
     }
 
     auto operator->() const noexcept {
@@ -350,7 +491,7 @@ class virtual_ptr {
         }
 
         virtual_ptr result;
-        result.box(obj);
+        result.box(std::forward<Other>(obj));
         result.vptr = vptr;
 
         return result;
@@ -375,7 +516,9 @@ class virtual_ptr {
 
     // consider as private, public for tests only
     auto _vptr() const noexcept {
-        if constexpr (is_indirect) {
+        if constexpr (is_generation_checked) {
+            return vptr.get();
+        } else if constexpr (is_indirect) {
             return *vptr;
         } else {
             return vptr;
@@ -398,6 +541,15 @@ inline auto make_virtual_shared() {
         std::make_shared<detail::virtual_ptr_class<Class>>());
 }
 
+template<class Class, class Policy = YOMM2_DEFAULT_POLICY>
+using virtual_unique_ptr = virtual_ptr<std::unique_ptr<Class>, Policy>;
+
+template<class Class, class Policy = YOMM2_DEFAULT_POLICY, typename... T>
+inline auto make_virtual_unique(T&&... args) {
+    return virtual_unique_ptr<Class, Policy>::final(
+        std::make_unique<Class>(std::forward<T>(args)...));
+}
+
 template<class Policy, class Class>
 inline auto final_virtual_ptr(Class& obj) {
     return virtual_ptr<Class, Policy>::final(obj);
@@ -408,6 +560,399 @@ inline auto final_virtual_ptr(Class& obj) {
     return virtual_ptr<Class>::final(obj);
 }
 
+// -----------------------------------------------------------------------------
+// virtual_value
+
+namespace detail {
+
+struct virtual_value_ops {
+    void (*copy)(void* to, const void* from);
+    void (*move)(void* to, void* from) noexcept;
+    void (*destroy)(void* obj) noexcept;
+};
+
+template<class Class>
+struct virtual_value_ops_aux {
+    static void copy(void* to, const void* from) {
+        new (to) Class(*static_cast<const Class*>(from));
+    }
+
+    // virtual_values are always nothrow movable, so they can be moved, not
+    // copied, when a vector grows. If the object's constructor throws, the
+    // program is terminated.
+    static void move(void* to, void* from) noexcept {
+        new (to) Class(std::move(*static_cast<Class*>(from)));
+    }
+
+    static void destroy(void* obj) noexcept {
+        static_cast<Class*>(obj)->~Class();
+    }
+};
+
+template<class Class>
+inline constexpr virtual_value_ops virtual_value_ops_for = {
+    std::is_copy_constructible_v<Class> ? virtual_value_ops_aux<Class>::copy
+                                        : nullptr,
+    virtual_value_ops_aux<Class>::move, virtual_value_ops_aux<Class>::destroy};
+
+} // namespace detail
+
+template<
+    class Class, std::size_t Size = 64,
+    std::size_t Align = alignof(std::max_align_t),
+    class Policy = YOMM2_DEFAULT_POLICY>
+class virtual_value {
+    static constexpr bool is_indirect =
+        Policy::template has_facet<policy::indirect_vptr>;
+    static constexpr bool is_generation_checked =
+        Policy::template has_facet<policy::generation_vptr>;
+
+    using vptr_type = std::conditional_t<
+        is_generation_checked, detail::generation_checked_vptr<Policy>,
+        std::conditional_t<
+            is_indirect, std::uintptr_t const* const*,
+            std::uintptr_t const*>>;
+
+    alignas(Align) unsigned char storage[Size];
+    const detail::virtual_value_ops* ops = nullptr;
+    Class* obj;
+    vptr_type vptr;
+
+    // Copy everything but the object, which has just been constructed in
+    // 'storage'. The offset of the 'Class' subobject is the same in both
+    // values.
+    void adopt(const virtual_value& other) noexcept {
+        ops = other.ops;
+        vptr = other.vptr;
+        obj = reinterpret_cast<Class*>(
+            storage + (reinterpret_cast<const unsigned char*>(other.obj) -
+                       other.storage));
+    }
+
+    void copy_from(const virtual_value& other) {
+        if (other.ops) {
+            BOOST_ASSERT(other.ops->copy);
+            other.ops->copy(storage, other.storage);
+            adopt(other);
+        }
+    }
+
+    void move_from(virtual_value& other) noexcept {
+        if (other.ops) {
+            other.ops->move(storage, other.storage);
+            adopt(other);
+        }
+    }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+  public:
+    using element_type = Class;
+
+    template<class Other, typename... Args>
+    explicit virtual_value(std::in_place_type_t<Other>, Args&&... args) {
+        static_assert(
+            std::is_base_of_v<Class, Other>, "Class must be a base of Other");
+        static_assert(
+            sizeof(Other) <= Size, "object does not fit in the inline storage");
+        static_assert(
+            alignof(Other) <= Align,
+            "object is more strictly aligned than the inline storage");
+
+        obj = new (storage) Other(std::forward<Args>(args)...);
+        ops = &detail::virtual_value_ops_for<Other>;
+
+        // The exact type of the object is known: no need to look up the
+        // v-table.
+        if constexpr (is_indirect) {
+            vptr = &Policy::template static_vptr<Other>;
+        } else {
+            vptr = Policy::template static_vptr<Other>;
+        }
+    }
+
+    template<
+        class Other,
+        typename = std::enable_if_t<
+            !std::is_same_v<std::decay_t<Other>, virtual_value>>>
+    virtual_value(Other&& other)
+        : virtual_value(
+              std::in_place_type<std::decay_t<Other>>,
+              std::forward<Other>(other)) {
+    }
+
+    virtual_value(const virtual_value& other) {
+        copy_from(other);
+    }
+
+    virtual_value(virtual_value&& other) noexcept {
+        move_from(other);
+    }
+
+    ~virtual_value() {
+        reset();
+    }
+
+    // If copying the object throws, the virtual_value is left empty. It can
+    // only be assigned to, or destroyed.
+    virtual_value& operator=(const virtual_value& other) {
+        if (this != &other) {
+            reset();
+            copy_from(other);
+        }
+
+        return *this;
+    }
+
+    virtual_value& operator=(virtual_value&& other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+
+        return *this;
+    }
+
+    Class* get() noexcept {
+        return obj;
+    }
+
+    const Class* get() const noexcept {
+        return obj;
+    }
+
+    Class* operator->() noexcept {
+        return obj;
+    }
+
+    const Class* operator->() const noexcept {
+        return obj;
+    }
+
+    Class& operator*() noexcept {
+        return *obj;
+    }
+
+    const Class& operator*() const noexcept {
+        return *obj;
+    }
+
+    // consider as private, public for tests only
+    auto _vptr() const noexcept {
+        if constexpr (is_generation_checked) {
+            return vptr.get();
+        } else if constexpr (is_indirect) {
+            return *vptr;
+        } else {
+            return vptr;
+        }
+    }
+};
+
+template<
+    class Class, class Other, std::size_t Size = 64,
+    std::size_t Align = alignof(std::max_align_t),
+    class Policy = YOMM2_DEFAULT_POLICY, typename... T>
+inline auto make_virtual_value(T&&... args) {
+    return virtual_value<Class, Size, Align, Policy>(
+        std::in_place_type<Other>, std::forward<T>(args)...);
+}
+
+// -----------------------------------------------------------------------------
+// interface
+
+template<class... Methods>
+class interface {
+    static_assert(sizeof...(Methods) > 0, "interface requires methods");
+    static_assert(
+        (... && (Methods::arity == 1)), "interface requires uni-methods");
+
+    using method_list = detail::types<Methods...>;
+    using policy_type =
+        typename boost::mp11::mp_first<method_list>::policy_type;
+
+    static_assert(
+        (... && std::is_same_v<typename Methods::policy_type, policy_type>),
+        "all the methods must use the same policy");
+
+    template<class Method>
+    using virtual_parameter = boost::mp11::mp_first<boost::mp11::mp_filter<
+        detail::is_virtual, typename Method::declared_argument_types>>;
+
+    // The type of the virtual parameter, without the 'virtual_' marker.
+    template<class Method>
+    using virtual_parameter_type =
+        detail::remove_virtual<virtual_parameter<Method>>;
+
+    template<class Method>
+    static constexpr std::size_t virtual_parameter_index =
+        boost::mp11::mp_find_if<
+            typename Method::declared_argument_types,
+            detail::is_virtual>::value;
+
+    // How the object is kept for a method: references are stored as pointers,
+    // pointers and virtual_ptrs as they are.
+    template<class Method>
+    using bound_type = std::conditional_t<
+        std::is_reference_v<virtual_parameter_type<Method>>,
+        std::remove_reference_t<virtual_parameter_type<Method>>*,
+        virtual_parameter_type<Method>>;
+
+    std::tuple<typename Methods::function_pointer_type...> functions;
+    std::tuple<bound_type<Methods>...> objects;
+
+    template<class Method, class Class>
+    static auto resolve(const virtual_ptr<Class, policy_type>& arg) {
+        // Whatever the kind of the virtual parameter, resolve_uni reads the
+        // v-table from the virtual_ptr.
+        return reinterpret_cast<typename Method::function_pointer_type>(
+            Method::fn.template resolve_uni<
+                detail::types<virtual_parameter<Method>>>(arg));
+    }
+
+    template<class Method, class Class>
+    static bound_type<Method> bind(const virtual_ptr<Class, policy_type>& arg) {
+        using parameter_type = virtual_parameter_type<Method>;
+
+        if constexpr (
+            std::is_reference_v<parameter_type> ||
+            std::is_pointer_v<parameter_type>) {
+            return &*arg;
+        } else {
+            return parameter_type(arg);
+        }
+    }
+
+    template<class Method>
+    decltype(auto) bound() const {
+        constexpr auto index = boost::mp11::mp_find<method_list, Method>::value;
+
+        if constexpr (std::is_reference_v<virtual_parameter_type<Method>>) {
+            return *std::get<index>(objects);
+        } else {
+            return std::get<index>(objects);
+        }
+    }
+
+    // Argument I of the call: the bound object at the position of the
+    // virtual parameter, the caller's arguments elsewhere.
+    template<class Method, std::size_t I, class Args>
+    decltype(auto) argument(Args& args) const {
+        constexpr auto index = virtual_parameter_index<Method>;
+
+        if constexpr (I == index) {
+            return bound<Method>();
+        } else {
+            return std::get<(I < index ? I : I - 1)>(std::move(args));
+        }
+    }
+
+    template<class Method, class Args, std::size_t... I>
+    decltype(auto) call_aux(Args&& args, std::index_sequence<I...>) const {
+        return get<Method>()(argument<Method, I>(args)...);
+    }
+
+  public:
+    template<class Class>
+    explicit interface(const virtual_ptr<Class, policy_type>& arg)
+        : functions(resolve<Methods>(arg)...),
+          objects(bind<Methods>(arg)...) {
+    }
+
+    template<
+        class Class,
+        typename = std::enable_if_t<
+            !detail::is_virtual_ptr<std::remove_cv_t<Class>>>>
+    explicit interface(Class& obj)
+        : interface(virtual_ptr<Class, policy_type>(obj)) {
+    }
+
+    template<class Method>
+    auto get() const noexcept {
+        return std::get<boost::mp11::mp_find<method_list, Method>::value>(
+            functions);
+    }
+
+    // Calls the function selected for 'Method', passing the object the
+    // interface was created for as the virtual argument, and 'args' as the
+    // other arguments.
+    template<class Method, typename... Args>
+    decltype(auto) call(Args&&... args) const {
+        constexpr auto size =
+            boost::mp11::mp_size<typename Method::declared_argument_types>::value;
+        static_assert(
+            sizeof...(Args) + 1 == size,
+            "pass the arguments of the method, except the virtual one");
+
+        return call_aux<Method>(
+            std::forward_as_tuple(std::forward<Args>(args)...),
+            std::make_index_sequence<size>());
+    }
+};
+
+// -----------------------------------------------------------------------------
+// enum_tag
+
+template<typename Enum>
+struct enum_tag {
+    static_assert(
+        std::is_enum_v<Enum> || std::is_integral_v<Enum>,
+        "enum_tag requires an enumeration or integral type");
+
+    using value_type = Enum;
+
+    enum_tag(Enum value) : value(value) {
+    }
+
+    Enum value;
+};
+
+template<typename Enum, Enum Value>
+struct enum_value : enum_tag<Enum> {
+    static_assert(
+        !detail::is_negative(
+            static_cast<typename std::conditional_t<
+                std::is_enum_v<Enum>, std::underlying_type<Enum>,
+                std::common_type<Enum>>::type>(Value)),
+        "enumerators used for dispatch must not be negative");
+
+    enum_value() : enum_tag<Enum>(Value) {
+    }
+};
+
+template<typename Enum, Enum... Values>
+using enum_values =
+    detail::types<enum_tag<Enum>, enum_value<Enum, Values>...>;
+
+// -----------------------------------------------------------------------------
+// overlay_scope
+
+template<class Overlay, class Policy = YOMM2_DEFAULT_POLICY>
+class overlay_scope {
+    static_assert(
+        Policy::template has_facet<policy::overlay>,
+        "overlays require a policy with an overlay facet");
+
+    std::ptrdiff_t previous;
+
+  public:
+    overlay_scope() : previous(Policy::overlay_offset) {
+        Policy::overlay_offset = Policy::overlay_image_offset(
+            Policy::template static_type<Overlay>());
+    }
+
+    overlay_scope(const overlay_scope&) = delete;
+
+    ~overlay_scope() {
+        Policy::overlay_offset = previous;
+    }
+};
+
 // -----------------------------------------------------------------------------
 // definitions
 
@@ -454,23 +999,94 @@ method<Key, R(A...), Policy>::resolve(const ArgType&... args) const {
 
     if constexpr (arity == 1) {
         pf = resolve_uni<types<A...>, ArgType...>(args...);
+    } else if constexpr (Policy::template has_facet<policy::runtime_checks>) {
+        pf = *resolve_multi_first<types<A...>, ArgType...>(args...);
     } else {
-        pf = resolve_multi_first<types<A...>, ArgType...>(args...);
+        // update() found out if the dispatch depends on fewer arguments.
+        auto vp = this->decisive_vp;
+
+        if (vp == all_vps) {
+            pf = *resolve_multi_first<types<A...>, ArgType...>(args...);
+        } else if (vp == arity) {
+            pf = this->dispatch_table[0];
+        } else {
+            pf = resolve_decisive<0, types<A...>, ArgType...>(vp, args...);
+        }
     }
 
     return reinterpret_cast<function_pointer_type>(pf);
 }
 
+template<typename Key, typename R, class Policy, typename... A>
+inline std::size_t
+method<Key, R(A...), Policy>::cell_of(detail::remove_virtual<A>... args) const {
+    using namespace detail;
+
+    static_assert(
+        arity > 1, "uni-methods have no dispatch table, use 'resolve'");
+
+    // Bypass the simplifications made by update(), they skip cells.
+    auto cell = resolve_multi_first<types<A...>>(
+        argument_traits<Policy, A>::rarg(args)...);
+
+    if constexpr (Policy::template has_facet<policy::overlay>) {
+        // Same coordinates in all the overlays.
+        cell -= Policy::overlay_offset;
+    }
+
+    return cell - this->dispatch_table;
+}
+
+template<typename Key, typename R, class Policy, typename... A>
+inline typename method<Key, R(A...), Policy>::function_pointer_type
+method<Key, R(A...), Policy>::target_of(std::size_t cell) const {
+    static_assert(
+        arity > 1, "uni-methods have no dispatch table, use 'resolve'");
+
+    auto table = this->dispatch_table;
+
+    if constexpr (Policy::template has_facet<policy::overlay>) {
+        table += Policy::overlay_offset;
+    }
+
+    return reinterpret_cast<function_pointer_type>(table[cell]);
+}
+
 template<typename Key, typename R, class Policy, typename... A>
 template<typename ArgType>
 inline const std::uintptr_t*
 method<Key, R(A...), Policy>::vptr(const ArgType& arg) const {
-    if constexpr (detail::is_virtual_ptr<ArgType>) {
-        return arg._vptr();
+    const std::uintptr_t* vtbl;
+
+    if constexpr (
+        detail::is_virtual_ptr<ArgType> || detail::is_virtual_value<ArgType>) {
+        vtbl = arg._vptr();
         // No need to check the method pointer: this was done when the
         // virtual_ptr was created.
+    } else if constexpr (detail::is_enum_tag<ArgType>) {
+        vtbl = detail::enum_vptrs<
+            Policy, typename ArgType::value_type>::vptr(arg.value);
+    } else {
+        vtbl = Policy::dynamic_vptr(arg);
+    }
+
+    if constexpr (Policy::template has_facet<policy::overlay>) {
+        // Select the v-table in the image of the current overlay, if any.
+        vtbl += Policy::overlay_offset;
+    }
+
+    return vtbl;
+}
+
+template<typename Key, typename R, class Policy, typename... A>
+inline const std::size_t*
+method<Key, R(A...), Policy>::slots_strides_data() const {
+    if constexpr (Policy::template has_facet<policy::packed_slots>) {
+        // update() moved the slots and strides of all the methods to a
+        // contiguous block, next to the v-tables.
+        return this->slots_strides_ptr;
     } else {
-        return Policy::dynamic_vptr(arg);
+        return slots_strides;
     }
 }
 
@@ -484,7 +1100,7 @@ inline void method<Key, R(A...), Policy>::check_static_offset(
         if (Policy::template has_facet<policy::error_handler>) {
             Error error;
             error.method = Policy::template static_type<method>();
-            error.expected = this->slots_strides[0];
+            error.expected = slots_strides_data()[0];
             error.actual = actual;
             Policy::error(error_type(std::move(error)));
 
@@ -502,22 +1118,17 @@ inline std::uintptr_t method<Key, R(A...), Policy>::resolve_uni(
     using namespace boost::mp11;
 
     if constexpr (is_virtual<mp_first<MethodArgList>>::value) {
-        const std::uintptr_t* vtbl;
-
-        if constexpr (is_virtual_ptr<ArgType>) {
-            vtbl = arg._vptr();
-        } else {
-            vtbl = vptr<ArgType>(arg);
-        }
+        auto vtbl = vptr<ArgType>(arg);
 
         if constexpr (has_static_offsets<method>::value) {
             if constexpr (Policy::template has_facet<policy::runtime_checks>) {
                 check_static_offset<static_slot_error>(
-                    static_offsets<method>::slots[0], this->slots_strides[0]);
+                    static_offsets<method>::slots[0],
+                    slots_strides_data()[0]);
             }
             return vtbl[static_offsets<method>::slots[0]];
         } else {
-            return vtbl[this->slots_strides[0]];
+            return vtbl[slots_strides_data()[0]];
         }
     } else {
         return resolve_uni<mp_rest<MethodArgList>>(more_args...);
@@ -526,20 +1137,15 @@ inline std::uintptr_t method<Key, R(A...), Policy>::resolve_uni(
 
 template<typename Key, typename R, class Policy, typename... A>
 template<typename MethodArgList, typename ArgType, typename... MoreArgTypes>
-inline std::uintptr_t method<Key, R(A...), Policy>::resolve_multi_first(
+inline const std::uintptr_t*
+method<Key, R(A...), Policy>::resolve_multi_first(
     const ArgType& arg, const MoreArgTypes&... more_args) const {
 
     using namespace detail;
     using namespace boost::mp11;
 
     if constexpr (is_virtual<mp_first<MethodArgList>>::value) {
-        const std::uintptr_t* vtbl;
-
-        if constexpr (is_virtual_ptr<ArgType>) {
-            vtbl = arg._vptr();
-        } else {
-            vtbl = vptr<ArgType>(arg);
-        }
+        auto vtbl = vptr<ArgType>(arg);
 
         std::size_t slot;
 
@@ -547,10 +1153,11 @@ inline std::uintptr_t method<Key, R(A...), Policy>::resolve_multi_first(
             slot = static_offsets<method>::slots[0];
             if constexpr (Policy::template has_facet<policy::runtime_checks>) {
                 check_static_offset<static_slot_error>(
-                    static_offsets<method>::slots[0], this->slots_strides[0]);
+                    static_offsets<method>::slots[0],
+                    slots_strides_data()[0]);
             }
         } else {
-            slot = this->slots_strides[0];
+            slot = slots_strides_data()[0];
         }
 
         // The first virtual parameter is special.  Since its stride is
@@ -570,22 +1177,35 @@ template<typename Key, typename R, class Policy, typename... A>
 template<
     std::size_t VirtualArg, typename MethodArgList, typename ArgType,
     typename... MoreArgTypes>
-inline std::uintptr_t method<Key, R(A...), Policy>::resolve_multi_next(
+inline const std::uintptr_t*
+method<Key, R(A...), Policy>::resolve_multi_next(
     const std::uintptr_t* dispatch, const ArgType& arg,
     const MoreArgTypes&... more_args) const {
 
     using namespace detail;
     using namespace boost::mp11;
 
-    if constexpr (is_virtual<mp_first<MethodArgList>>::value) {
-        const std::uintptr_t* vtbl;
+    if constexpr (
+        is_virtual<mp_first<MethodArgList>>::value &&
+        Policy::template has_facet<policy::morton_order>) {
+        auto vtbl = vptr<ArgType>(arg);
+        std::size_t slot;
 
-        if constexpr (is_virtual_ptr<ArgType>) {
-            vtbl = arg._vptr();
+        if constexpr (has_static_offsets<method>::value) {
+            slot = static_offsets<method>::slots[VirtualArg];
+            if constexpr (Policy::template has_facet<policy::runtime_checks>) {
+                check_static_offset<static_slot_error>(
+                    slots_strides_data()[VirtualArg], slot);
+            }
         } else {
-            vtbl = vptr<ArgType>(arg);
+            slot = slots_strides_data()[VirtualArg];
         }
 
+        // The bits of the group indexes are interleaved: no stride.
+        dispatch = dispatch + vtbl[slot];
+    } else if constexpr (is_virtual<mp_first<MethodArgList>>::value) {
+        auto vtbl = vptr<ArgType>(arg);
+
         std::size_t slot, stride;
 
         if constexpr (has_static_offsets<method>::value) {
@@ -593,20 +1213,20 @@ inline std::uintptr_t method<Key, R(A...), Policy>::resolve_multi_next(
             stride = static_offsets<method>::strides[VirtualArg - 1];
             if constexpr (Policy::template has_facet<policy::runtime_checks>) {
                 check_static_offset<static_slot_error>(
-                    this->slots_strides[VirtualArg], slot);
+                    slots_strides_data()[VirtualArg], slot);
                 check_static_offset<static_stride_error>(
-                    this->slots_strides[2 * VirtualArg], stride);
+                    slots_strides_data()[2 * VirtualArg], stride);
             }
         } else {
-            slot = this->slots_strides[VirtualArg];
-            stride = this->slots_strides[arity + VirtualArg - 1];
+            slot = slots_strides_data()[VirtualArg];
+            stride = slots_strides_data()[arity + VirtualArg - 1];
         }
 
         dispatch = dispatch + vtbl[slot] * stride;
     }
 
     if constexpr (VirtualArg + 1 == arity) {
-        return *dispatch;
+        return dispatch;
     } else {
         return resolve_multi_next<
             VirtualArg + 1, mp_rest<MethodArgList>, MoreArgTypes...>(
@@ -614,6 +1234,43 @@ inline std::uintptr_t method<Key, R(A...), Policy>::resolve_multi_next(
     }
 }
 
+template<typename Key, typename R, class Policy, typename... A>
+template<
+    std::size_t VirtualArg, typename MethodArgList, typename ArgType,
+    typename... MoreArgTypes>
+inline std::uintptr_t method<Key, R(A...), Policy>::resolve_decisive(
+    std::size_t vp, const ArgType& arg,
+    const MoreArgTypes&... more_args) const {
+
+    using namespace detail;
+    using namespace boost::mp11;
+
+    if constexpr (is_virtual<mp_first<MethodArgList>>::value) {
+        if constexpr (VirtualArg + 1 < arity) {
+            if (vp != VirtualArg) {
+                return resolve_decisive<
+                    VirtualArg + 1, mp_rest<MethodArgList>, MoreArgTypes...>(
+                    vp, more_args...);
+            }
+        }
+
+        auto vtbl = vptr<ArgType>(arg);
+        auto entry = vtbl[slots_strides_data()[VirtualArg]];
+
+        // The other arguments are taken to be in their first group.
+        if constexpr (VirtualArg == 0) {
+            return *reinterpret_cast<const std::uintptr_t*>(entry);
+        } else {
+            return this->dispatch_table
+                [entry * slots_strides_data()[arity + VirtualArg - 1]];
+        }
+    } else {
+        return resolve_decisive<
+            VirtualArg, mp_rest<MethodArgList>, MoreArgTypes...>(
+            vp, more_args...);
+    }
+}
+
 template<typename Key, typename R, class Policy, typename... A>
 BOOST_NORETURN typename method<Key, R(A...), Policy>::return_type
 method<Key, R(A...), Policy>::not_implemented_handler(
@@ -657,6 +1314,76 @@ method<Key, R(A...), Policy>::ambiguous_handler(
     abort(); // in case user handler "forgets" to abort
 }
 
+// -----------------------------------------------------------------------------
+// subtype tests
+
+namespace detail {
+
+// A uni-method that returns its argument cast to Target, or a null pointer.
+// The v-table entry of each class points to one of the two definitions, thus
+// the dispatch data doubles as a table of subtype tests.
+
+template<class Target, class Source, class Policy>
+struct downcast {
+    static_assert(
+        std::is_base_of_v<Source, Target>,
+        "target must be derived from the static type of the object");
+
+    using method_type = method<downcast, Target*(virtual_<Source&>), Policy>;
+
+    static Target* yes(Target& obj) {
+        return &obj;
+    }
+
+    static Target* no(Source&) {
+        return nullptr;
+    }
+
+    using definitions_type =
+        typename method_type::template add_functions<yes, no>;
+    static definitions_type definitions;
+
+    static auto fail() {
+        // The pointer stored in the v-tables, as selected by the thunk.
+        return reinterpret_cast<typename method_type::function_pointer_type>(
+            thunk<Policy, Target*(virtual_<Source&>), no, types<Source&>>::
+                address());
+    }
+};
+
+template<class Target, class Source, class Policy>
+typename downcast<Target, Source, Policy>::definitions_type
+    downcast<Target, Source, Policy>::definitions;
+
+} // namespace detail
+
+template<class Target, class Policy = YOMM2_DEFAULT_POLICY, class Source>
+inline bool is_a(const Source& obj) {
+    if constexpr (std::is_same_v<Target, Source>) {
+        return true;
+    } else {
+        using downcast = detail::downcast<Target, Source, Policy>;
+        (void)&downcast::definitions; // register the definitions
+        return downcast::method_type::fn.resolve(obj) != downcast::fail();
+    }
+}
+
+template<class Target, class Policy = YOMM2_DEFAULT_POLICY, class Source>
+inline auto checked_cast(Source& obj) {
+    using class_type = std::remove_cv_t<Source>;
+    using result_type =
+        std::conditional_t<std::is_const_v<Source>, const Target*, Target*>;
+
+    if constexpr (std::is_same_v<Target, class_type>) {
+        return result_type(&obj);
+    } else {
+        using downcast = detail::downcast<Target, class_type, Policy>;
+        (void)&downcast::definitions; // register the definitions
+        return result_type(
+            downcast::method_type::fn(const_cast<class_type&>(obj)));
+    }
+}
+
 } // namespace yomm2
 } // namespace yorel
 
@@ -665,12 +1392,16 @@ method<Key, R(A...), Policy>::ambiguous_handler(
 namespace yorel {
 namespace yomm2 {
 
-#ifdef YOMM2_SHARED
-
 #ifndef BOOST_NO_RTTI
-yOMM2_API auto update() -> detail::compiler<policy::debug_shared>;
+template<class Policy = YOMM2_DEFAULT_POLICY>
+auto update() -> detail::compiler<Policy>;
 #endif
 
+#ifdef YOMM2_SHARED
+
+// The shared library contains instantiations of 'update' for both
+// 'debug_shared' and 'release_shared', and the error handler setters below
+// apply to both.
 yOMM2_API error_handler_type set_error_handler(error_handler_type handler);
 yOMM2_API method_call_error_handler
 set_method_call_error_handler(method_call_error_handler handler);
@@ -679,9 +1410,6 @@ set_method_call_error_handler(method_call_error_handler handler);
 
 #ifndef BOOST_NO_RTTI
 
-template<class Policy = YOMM2_DEFAULT_POLICY>
-auto update() -> detail::compiler<Policy>;
-
 inline error_handler_type set_error_handler(error_handler_type handler) {
     auto p = &default_policy::error;
     auto prev = default_policy::error;
@@ -716,6 +1444,19 @@ auto update() -> typename detail::compiler<Policy> {
     return compiler;
 }
 
+#if defined(YOMM2_SHARED) && !defined(yOMM2_DLL) && !defined(BOOST_NO_RTTI)
+
+// Instantiated in the shared library; don't instantiate them again in every
+// client translation unit.
+
+extern template yOMM2_API_msc auto update<policy::debug_shared>()
+    -> detail::compiler<policy::debug_shared>;
+
+extern template yOMM2_API_msc auto update<policy::release_shared>()
+    -> detail::compiler<policy::release_shared>;
+
+#endif
+
 } // namespace yomm2
 } // namespace yorel
 
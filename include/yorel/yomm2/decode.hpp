@@ -102,6 +102,7 @@ void decode_dispatch_data(Data& init) {
                 indent _(trace);
 
                 dispatch_tables[method_index] = dtbl_iter;
+                method.dispatch_table = dtbl_iter;
                 ++trace << "multi-method " << method_index
                         << " dispatch table at " << dtbl_iter << "\n";
 
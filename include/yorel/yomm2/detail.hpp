@@ -3,6 +3,9 @@
 
 #include <yorel/yomm2/detail/static_list.hpp>
 
+#include <algorithm>
+#include <any>
+
 #include <boost/assert.hpp>
 
 namespace yorel {
@@ -149,6 +152,196 @@ const char* default_method_name() {
 #endif
 }
 
+// -----------------------------------------------------------------------------
+// enum_tag registration
+
+template<typename>
+struct is_enum_tag_aux : std::false_type {};
+
+template<typename Enum>
+struct is_enum_tag_aux<enum_tag<Enum>> : std::true_type {};
+
+template<typename T>
+constexpr bool is_enum_tag = is_enum_tag_aux<T>::value;
+
+template<typename>
+struct enum_value_traits {
+    static constexpr bool is_enum_value = false;
+};
+
+template<typename Enum, Enum Value>
+struct enum_value_traits<enum_value<Enum, Value>> {
+    static constexpr bool is_enum_value = true;
+    using enum_type = Enum;
+    static constexpr Enum value = Value;
+};
+
+// Pointers to the static vptrs of the registered enumerators. Small values are
+// looked up in a table indexed by value, the others in an array of (value,
+// vptr) pairs sorted by value, so large or sparse values do not blow up
+// memory. Values that are not registered map to the static vptr of the
+// 'enum_tag' itself. The same value can be registered several times, e.g. by
+// a program and a plugin: it remains registered until it is removed as many
+// times. The tables are managed by hand, because they are populated during
+// static construction, in unspecified order; they are freed when the last
+// value is removed.
+template<class Policy, typename Enum>
+struct yOMM2_API_gcc enum_vptrs {
+    static constexpr std::size_t max_dense_size = 256;
+
+    struct dense_entry {
+        std::uintptr_t** vptr;
+        std::size_t count;
+    };
+
+    struct sparse_entry {
+        std::size_t value;
+        std::uintptr_t** vptr;
+        std::size_t count;
+    };
+
+    static dense_entry* vptrs;
+    static std::size_t size;
+    static sparse_entry* sparse;
+    static std::size_t sparse_size;
+    static std::size_t count;
+
+    static std::uintptr_t** default_vptr() {
+        return &Policy::template static_vptr<enum_tag<Enum>>;
+    }
+
+    static sparse_entry* find_sparse(std::size_t index) {
+        return std::lower_bound(
+            sparse, sparse + sparse_size, index,
+            [](const sparse_entry& entry, std::size_t index) {
+                return entry.value < index;
+            });
+    }
+
+    static void add(Enum value, std::uintptr_t** static_vptr) {
+        auto index = static_cast<std::size_t>(value);
+        ++count;
+
+        if (index < max_dense_size) {
+            if (index >= size) {
+                auto new_vptrs = new dense_entry[index + 1];
+                std::copy_n(vptrs, size, new_vptrs);
+                std::fill(
+                    new_vptrs + size, new_vptrs + index + 1,
+                    dense_entry{default_vptr(), 0});
+                delete[] vptrs;
+                vptrs = new_vptrs;
+                size = index + 1;
+            }
+
+            vptrs[index].vptr = static_vptr;
+            ++vptrs[index].count;
+
+            return;
+        }
+
+        auto iter = find_sparse(index);
+
+        if (iter != sparse + sparse_size && iter->value == index) {
+            iter->vptr = static_vptr;
+            ++iter->count;
+
+            return;
+        }
+
+        auto position = iter - sparse;
+        auto new_sparse = new sparse_entry[sparse_size + 1];
+        std::copy_n(sparse, position, new_sparse);
+        new_sparse[position] = {index, static_vptr, 1};
+        std::copy(
+            sparse + position, sparse + sparse_size, new_sparse + position + 1);
+        delete[] sparse;
+        sparse = new_sparse;
+        ++sparse_size;
+    }
+
+    static void remove(Enum value) {
+        auto index = static_cast<std::size_t>(value);
+
+        if (index < size) {
+            auto& entry = vptrs[index];
+
+            if (entry.count == 0) {
+                return;
+            }
+
+            if (--entry.count == 0) {
+                entry.vptr = default_vptr();
+            }
+        } else {
+            auto iter = find_sparse(index);
+
+            if (iter == sparse + sparse_size || iter->value != index) {
+                return;
+            }
+
+            if (--iter->count == 0) {
+                std::copy(iter + 1, sparse + sparse_size, iter);
+                --sparse_size;
+            }
+        }
+
+        if (--count == 0) {
+            delete[] vptrs;
+            vptrs = nullptr;
+            size = 0;
+            delete[] sparse;
+            sparse = nullptr;
+            sparse_size = 0;
+        }
+    }
+
+    static const std::uintptr_t* vptr(Enum value) {
+        auto index = static_cast<std::size_t>(value);
+
+        if (index < size) {
+            return *vptrs[index].vptr;
+        }
+
+        if (sparse_size) {
+            auto iter = find_sparse(index);
+
+            if (iter != sparse + sparse_size && iter->value == index) {
+                return *iter->vptr;
+            }
+        }
+
+        return Policy::template static_vptr<enum_tag<Enum>>;
+    }
+};
+
+template<class Policy, typename Enum>
+typename enum_vptrs<Policy, Enum>::dense_entry*
+    enum_vptrs<Policy, Enum>::vptrs;
+
+template<class Policy, typename Enum>
+std::size_t enum_vptrs<Policy, Enum>::size;
+
+template<class Policy, typename Enum>
+typename enum_vptrs<Policy, Enum>::sparse_entry*
+    enum_vptrs<Policy, Enum>::sparse;
+
+template<class Policy, typename Enum>
+std::size_t enum_vptrs<Policy, Enum>::sparse_size;
+
+template<class Policy, typename Enum>
+std::size_t enum_vptrs<Policy, Enum>::count;
+
+// Whether a value is negative, without warnings for unsigned types.
+template<typename T>
+constexpr bool is_negative(T value) {
+    if constexpr (std::is_signed_v<T>) {
+        return value < 0;
+    } else {
+        return false;
+    }
+}
+
 template<class...>
 struct class_declaration_aux;
 
@@ -162,10 +355,20 @@ struct class_declaration_aux<Policy, detail::types<Class, Bases...>>
         Policy::classes.push_back(*this);
         this->is_abstract = std::is_abstract_v<Class>;
         this->static_vptr = &Policy::template static_vptr<Class>;
+
+        if constexpr (enum_value_traits<Class>::is_enum_value) {
+            enum_vptrs<Policy, typename enum_value_traits<Class>::enum_type>::
+                add(enum_value_traits<Class>::value, this->static_vptr);
+        }
     }
 
     ~class_declaration_aux() {
         Policy::classes.remove(*this);
+
+        if constexpr (enum_value_traits<Class>::is_enum_value) {
+            enum_vptrs<Policy, typename enum_value_traits<Class>::enum_type>::
+                remove(enum_value_traits<Class>::value);
+        }
     }
 };
 
@@ -182,6 +385,14 @@ struct yOMM2_API method_info : static_list<method_info>::static_link {
     type_id method_type;
     std::size_t* slots_strides_ptr;
 
+    // Set by update() for the multi-methods whose dispatch does not depend on
+    // all the virtual arguments: the index of the only virtual argument that
+    // matters, or the arity if none does. 'dispatch_table' is the method's
+    // dispatch table in the policy's dispatch data.
+    static constexpr std::size_t all_vps = std::size_t(-1);
+    std::size_t decisive_vp = all_vps;
+    const std::uintptr_t* dispatch_table = nullptr;
+
     auto arity() const {
         return std::distance(vp_begin, vp_end);
     }
@@ -312,6 +523,20 @@ struct virtual_ptr_traits {
     using polymorphic_type = Class;
 };
 
+template<class Class, class Policy>
+struct virtual_ptr_traits<std::unique_ptr<Class>, Policy> {
+    static bool constexpr is_smart_ptr = true;
+    using polymorphic_type = Class;
+
+    template<typename OtherPtrRef>
+    static auto cast(const std::unique_ptr<Class>&) {
+        static_assert(
+            !std::is_same_v<OtherPtrRef, OtherPtrRef>,
+            "virtual_unique_ptr cannot be passed to methods; use virtual_ptr "
+            "parameters, which borrow the object");
+    }
+};
+
 template<class Class, class Policy>
 struct virtual_ptr_traits<std::shared_ptr<Class>, Policy> {
     static bool constexpr is_smart_ptr = true;
@@ -363,11 +588,132 @@ struct is_virtual_ptr_aux<const virtual_ptr<Class, Policy>&> : std::true_type {
 template<typename T>
 constexpr bool is_virtual_ptr = is_virtual_ptr_aux<T>::value;
 
+// -----------------------------------------------------------------------------
+// virtual_value
+
+template<class Class, std::size_t Size, std::size_t Align, class Policy>
+struct is_virtual<virtual_value<Class, Size, Align, Policy>&>
+    : std::true_type {};
+
+template<class Class, std::size_t Size, std::size_t Align, class Policy>
+struct is_virtual<const virtual_value<Class, Size, Align, Policy>&>
+    : std::true_type {};
+
+template<class Policy, class Class, std::size_t Size, std::size_t Align>
+struct virtual_traits<Policy, virtual_value<Class, Size, Align, Policy>&> {
+    using polymorphic_type = Class;
+    using value_type = virtual_value<Class, Size, Align, Policy>;
+
+    static const value_type& rarg(const value_type& value) {
+        return value;
+    }
+
+    template<typename D>
+    static D& cast(value_type& value) {
+        return optimal_cast<Policy, D&>(*value);
+    }
+};
+
+template<class Policy, class Class, std::size_t Size, std::size_t Align>
+struct virtual_traits<
+    Policy, const virtual_value<Class, Size, Align, Policy>&> {
+    using polymorphic_type = Class;
+    using value_type = virtual_value<Class, Size, Align, Policy>;
+
+    static const value_type& rarg(const value_type& value) {
+        return value;
+    }
+
+    template<typename D>
+    static D& cast(const value_type& value) {
+        return optimal_cast<Policy, D&>(*value);
+    }
+};
+
+template<typename>
+struct is_virtual_value_aux : std::false_type {};
+
+template<class Class, std::size_t Size, std::size_t Align, class Policy>
+struct is_virtual_value_aux<virtual_value<Class, Size, Align, Policy>>
+    : std::true_type {};
+
+template<typename T>
+constexpr bool is_virtual_value = is_virtual_value_aux<T>::value;
+
 template<class... Ts>
 using virtual_ptr_class = std::conditional_t<
     sizeof...(Ts) == 2, boost::mp11::mp_second<detail::types<Ts..., void>>,
     boost::mp11::mp_first<detail::types<Ts...>>>;
 
+// -----------------------------------------------------------------------------
+// enum_tag
+
+template<class Policy, typename Enum>
+struct virtual_traits<Policy, enum_tag<Enum>> {
+    using polymorphic_type = enum_tag<Enum>;
+
+    static const enum_tag<Enum>& rarg(const enum_tag<Enum>& arg) {
+        return arg;
+    }
+
+    template<typename D>
+    static auto cast(const enum_tag<Enum>& tag) {
+        using tag_type = std::remove_cv_t<std::remove_reference_t<D>>;
+
+        if constexpr (std::is_same_v<tag_type, enum_tag<Enum>>) {
+            return tag;
+        } else {
+            // The value is encoded in the type.
+            return tag_type();
+        }
+    }
+};
+
+template<class Policy, typename Enum, Enum Value>
+struct virtual_traits<Policy, enum_value<Enum, Value>> {
+    using polymorphic_type = enum_value<Enum, Value>;
+};
+
+// -----------------------------------------------------------------------------
+// std::any
+
+// A std::any is dispatched on the type of the object it contains, which must
+// be registered, along with std::any itself. Definitions receive a reference
+// to the contained object.
+
+template<class Policy, typename Any>
+struct any_virtual_traits {
+    using polymorphic_type = std::any;
+
+    static const std::any& rarg(const std::any& arg) {
+        return arg;
+    }
+
+    template<typename D>
+    static D cast(Any& obj) {
+        using payload_type = std::remove_cv_t<std::remove_reference_t<D>>;
+
+        if constexpr (std::is_same_v<payload_type, std::any>) {
+            return obj;
+        } else {
+            // any_cast only succeeds for the exact type of the contained
+            // object.
+            auto payload = std::any_cast<payload_type>(&obj);
+            BOOST_ASSERT(payload);
+
+            return *payload;
+        }
+    }
+};
+
+template<class Policy>
+struct virtual_traits<Policy, std::any&>
+    : any_virtual_traits<Policy, std::any> {};
+
+template<class Policy>
+struct virtual_traits<Policy, const std::any&>
+    : any_virtual_traits<Policy, const std::any> {};
+
 template<class Policy, typename T>
 struct argument_traits {
     static const T& rarg(const T& arg) {
@@ -391,6 +737,16 @@ template<class Policy, class Class>
 struct argument_traits<Policy, const virtual_ptr<Class, Policy>&>
     : virtual_traits<Policy, const virtual_ptr<Class, Policy>&> {};
 
+template<class Policy, class Class, std::size_t Size, std::size_t Align>
+struct argument_traits<Policy, virtual_value<Class, Size, Align, Policy>&>
+    : virtual_traits<Policy, virtual_value<Class, Size, Align, Policy>&> {};
+
+template<class Policy, class Class, std::size_t Size, std::size_t Align>
+struct argument_traits<
+    Policy, const virtual_value<Class, Size, Align, Policy>&>
+    : virtual_traits<
+          Policy, const virtual_value<Class, Size, Align, Policy>&> {};
+
 template<typename T>
 struct shared_ptr_traits {
     static const bool is_shared_ptr = false;
@@ -475,6 +831,22 @@ struct virtual_traits<Policy, std::shared_ptr<T>> {
     }
 };
 
+// Only used to construct virtual_unique_ptrs: unique_ptrs cannot be passed
+// as virtual arguments.
+
+template<class Policy, typename T>
+struct virtual_traits<Policy, std::unique_ptr<T>> {
+    using polymorphic_type = std::remove_cv_t<T>;
+
+    static const T& rarg(const std::unique_ptr<T>& arg) {
+        return *arg;
+    }
+};
+
+template<class Policy, typename T>
+struct virtual_traits<Policy, const std::unique_ptr<T>&>
+    : virtual_traits<Policy, std::unique_ptr<T>> {};
+
 template<typename MethodArgList>
 using polymorphic_types = mp11::mp_transform<
     remove_virtual, mp11::mp_filter<detail::is_virtual, MethodArgList>>;
@@ -503,6 +875,22 @@ struct select_spec_polymorphic_type_aux<
         Policy, const virtual_ptr<Q, Policy>&>::polymorphic_type;
 };
 
+template<
+    class Policy, class Class, std::size_t Size, std::size_t Align,
+    typename Q>
+struct select_spec_polymorphic_type_aux<
+    Policy, virtual_value<Class, Size, Align, Policy>&, Q> {
+    using type = polymorphic_type<Policy, Q>;
+};
+
+template<
+    class Policy, class Class, std::size_t Size, std::size_t Align,
+    typename Q>
+struct select_spec_polymorphic_type_aux<
+    Policy, const virtual_value<Class, Size, Align, Policy>&, Q> {
+    using type = polymorphic_type<Policy, Q>;
+};
+
 template<class Policy, typename P, typename Q>
 using select_spec_polymorphic_type =
     typename select_spec_polymorphic_type_aux<Policy, P, Q>::type;
@@ -542,6 +930,28 @@ struct thunk<Policy, BASE_RETURN(BASE_PARAM...), SPEC, types<SPEC_PARAM...>> {
             argument_traits<Policy, BASE_PARAM>::template cast<SPEC_PARAM>(
                 remove_virtual<BASE_PARAM>(arg))...);
     }
+
+    // The address to store in the dispatch data: the definition itself, if its
+    // type is exactly that of the method, saving a call; 'fn' otherwise. The
+    // decision is made at compile time. Even when no cast is needed, or when
+    // it would not adjust the address, calling a function through a pointer to
+    // a different function type is undefined behavior, so we don't.
+    static void* address() {
+        using function_type = BASE_RETURN (*)(remove_virtual<BASE_PARAM>...);
+        using spec_return_type =
+            decltype(SPEC(std::declval<SPEC_PARAM>()...));
+
+        if constexpr (
+            std::is_same_v<spec_return_type, BASE_RETURN> &&
+            std::is_same_v<
+                types<remove_virtual<BASE_PARAM>...>, types<SPEC_PARAM...>> &&
+            std::is_convertible_v<decltype(SPEC), function_type>) {
+            function_type direct = SPEC;
+            return (void*)direct;
+        } else {
+            return (void*)fn;
+        }
+    }
 };
 
 template<typename Method, typename Container>
@@ -562,15 +972,22 @@ struct member_function_thunk<F, R (C::*)(Args...)> {
     }
 };
 
+// As std::is_base_of, but std::any is also a base of all the classes.
+template<class Base, class Derived>
+struct is_base_of : std::is_base_of<Base, Derived> {};
+
+template<class Derived>
+struct is_base_of<std::any, Derived> : std::true_type {};
+
 // Collect the base classes of a list of classes. The result is a mp11 map that
 // associates each class to a list starting with the class itself, followed by
-// all its bases, as per std::is_base_of. Thus the list includes the class
+// all its bases, as per is_base_of. Thus the list includes the class
 // itself at least twice: at the front, and down the list, as its own improper
 // base. The direct and its direct and indirect proper bases are included. The
 // runtime will extract the direct proper bases. See unit tests for an example.
 template<typename... Cs>
 using inheritance_map = types<mp11::mp_push_front<
-    mp11::mp_filter_q<mp11::mp_bind_back<std::is_base_of, Cs>, types<Cs...>>,
+    mp11::mp_filter_q<mp11::mp_bind_back<is_base_of, Cs>, types<Cs...>>,
     Cs>...>;
 
 template<class Policy, class... Classes>
@@ -7,6 +7,7 @@
 #define YOREL_YOMM2_DETAIL_COMPILER_HPP
 
 #include <yorel/yomm2/core.hpp>
+#include <yorel/yomm2/detail/events.hpp>
 #include <yorel/yomm2/detail/ostdstream.hpp>
 #include <yorel/yomm2/detail/trace.hpp>
 
@@ -15,6 +16,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -29,7 +31,11 @@ namespace yorel {
 namespace yomm2 {
 namespace detail {
 
-struct update_report : update_method_report {};
+struct update_report : update_method_report {
+    std::size_t allocations = 0;
+    std::size_t allocated_bytes = 0;
+    std::size_t simplified_methods = 0;
+};
 
 template<class Reports, class Facets, typename = void>
 struct aggregate_reports;
@@ -63,7 +69,8 @@ template<class Policy>
 using report_type = typename aggregate_reports<
     types<update_report>, typename Policy::facets>::type;
 
-inline void merge_into(boost::dynamic_bitset<>& a, boost::dynamic_bitset<>& b) {
+template<class Bitset>
+void merge_into(Bitset& a, Bitset& b) {
     if (b.size() < a.size()) {
         b.resize(a.size());
     }
@@ -75,7 +82,8 @@ inline void merge_into(boost::dynamic_bitset<>& a, boost::dynamic_bitset<>& b) {
     }
 }
 
-inline void set_bit(boost::dynamic_bitset<>& mask, std::size_t bit) {
+template<class Bitset>
+void set_bit(Bitset& mask, std::size_t bit) {
     if (bit >= mask.size()) {
         mask.resize(bit + 1);
     }
@@ -85,6 +93,33 @@ inline void set_bit(boost::dynamic_bitset<>& mask, std::size_t bit) {
 
 struct generic_compiler {
 
+    // The compiler's data structures are allocated from an arena, and released
+    // all at once when the compiler is destroyed. It also counts the
+    // allocations, for the update report.
+    struct arena : std::pmr::memory_resource {
+        std::pmr::monotonic_buffer_resource buffer;
+        std::size_t allocations = 0;
+        std::size_t bytes = 0;
+
+        void* do_allocate(std::size_t size, std::size_t alignment) override {
+            ++allocations;
+            bytes += size;
+
+            return buffer.allocate(size, alignment);
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override {
+        }
+
+        bool do_is_equal(
+            const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    using slot_set = boost::dynamic_bitset<
+        unsigned long, std::pmr::polymorphic_allocator<unsigned long>>;
+
     struct method;
 
     struct parameter {
@@ -97,19 +132,26 @@ struct generic_compiler {
     };
 
     struct class_ {
+        explicit class_(std::pmr::memory_resource* memory)
+            : type_ids(memory), transitive_bases(memory), direct_bases(memory),
+              direct_derived(memory), covariant_classes(memory),
+              used_by_vp(memory), used_slots(memory), reserved_slots(memory),
+              vtbl(memory) {
+        }
+
         bool is_abstract = false;
-        std::vector<type_id> type_ids;
-        std::vector<class_*> transitive_bases;
-        std::vector<class_*> direct_bases;
-        std::vector<class_*> direct_derived;
-        std::unordered_set<class_*> covariant_classes;
-        std::vector<parameter> used_by_vp;
-        boost::dynamic_bitset<> used_slots;
-        boost::dynamic_bitset<> reserved_slots;
+        std::pmr::vector<type_id> type_ids;
+        std::pmr::vector<class_*> transitive_bases;
+        std::pmr::vector<class_*> direct_bases;
+        std::pmr::vector<class_*> direct_derived;
+        std::pmr::unordered_set<class_*> covariant_classes;
+        std::pmr::vector<parameter> used_by_vp;
+        slot_set used_slots;
+        slot_set reserved_slots;
         std::size_t first_slot = 0;
         std::size_t mark = 0;   // temporary mark to detect cycles
         std::size_t weight = 0; // number of proper direct or indirect bases
-        std::vector<vtbl_entry> vtbl;
+        std::pmr::vector<vtbl_entry> vtbl;
         std::uintptr_t** static_vptr;
 
         const std::uintptr_t* vptr() const {
@@ -130,44 +172,68 @@ struct generic_compiler {
     };
 
     struct definition {
-        const detail::definition_info* info;
-        std::vector<class_*> vp;
-        std::uintptr_t pf;
-        std::size_t method_index, spec_index;
+        explicit definition(std::pmr::memory_resource* memory) : vp(memory) {
+        }
+
+        const detail::definition_info* info = nullptr;
+        std::pmr::vector<class_*> vp;
+        std::uintptr_t pf = 0;
+        std::size_t method_index = 0, spec_index = 0;
+        std::size_t image = 0; // 0, or 1 + index of the overlay
     };
 
+    // Not allocated from the arena, because dynamic_bitset cannot be copied
+    // with an allocator, as required for the keys of a pmr::map.
     using bitvec = boost::dynamic_bitset<>;
 
     struct group {
-        std::vector<class_*> classes;
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+        explicit group(const allocator_type& alloc) : classes(alloc) {
+        }
+
+        std::pmr::vector<class_*> classes;
         bool has_concrete_classes{false};
     };
 
-    using group_map = std::map<bitvec, group>;
+    using group_map = std::pmr::map<bitvec, group>;
 
     static void
     accumulate(const update_method_report& partial, update_report& total);
 
     struct method {
-        detail::method_info* info;
-        std::vector<class_*> vp;
-        std::vector<definition> specs;
-        std::vector<std::size_t> slots;
-        std::vector<std::size_t> strides;
-        std::vector<const definition*> dispatch_table;
+        explicit method(std::pmr::memory_resource* memory)
+            : vp(memory), specs(memory), slots(memory), strides(memory),
+              dispatch_table(memory), overlay_dispatch_tables(memory),
+              not_implemented(memory), ambiguous(memory) {
+        }
+
+        detail::method_info* info = nullptr;
+        std::pmr::vector<class_*> vp;
+        std::pmr::vector<definition> specs;
+        std::pmr::vector<std::size_t> slots;
+        std::pmr::vector<std::size_t> strides;
+        std::pmr::vector<const definition*> dispatch_table;
+        std::pmr::vector<std::pmr::vector<const definition*>>
+            overlay_dispatch_tables;
         // following two are dummies, when converting to a function pointer, we will
         // get the corresponding pointer from method_info
         definition not_implemented;
         definition ambiguous;
         const std::uintptr_t* gv_dispatch_table{nullptr};
+        std::size_t decisive_vp = method_info::all_vps;
         auto arity() const {
             return vp.size();
         }
         update_method_report report;
     };
 
-    std::deque<class_> classes;
-    std::vector<method> methods;
+    // Declared first, so it is destroyed last. Shared by the copies of the
+    // compiler.
+    std::shared_ptr<arena> memory = std::make_shared<arena>();
+    std::pmr::deque<class_> classes{memory.get()};
+    std::pmr::vector<method> methods{memory.get()};
+    std::pmr::vector<type_id> overlays{memory.get()};
     std::size_t class_mark = 0;
     bool compilation_done = false;
 };
@@ -232,7 +298,8 @@ struct compiler : generic_compiler {
         types<update_report>, typename Policy::facets>::type
         report;
 
-    std::unordered_map<type_index_type, class_*> class_map;
+    std::pmr::unordered_map<type_index_type, class_*> class_map{
+        memory.get()};
 
     compiler();
 
@@ -250,12 +317,18 @@ struct compiler : generic_compiler {
     void build_dispatch_tables();
     void build_dispatch_table(
         method& m, std::size_t dim,
-        std::vector<group_map>::const_iterator group, const bitvec& candidates,
-        bool concrete);
+        std::pmr::vector<group_map>::const_iterator group,
+        const bitvec& candidates, bool concrete);
+    void
+    find_decisive_vp(method& m, const std::pmr::vector<group_map>& groups);
+    void
+    make_morton_order(method& m, const std::pmr::vector<group_map>& groups);
     void install_gv();
     void print(const update_method_report& report) const;
-    static std::vector<const definition*>
-    best(std::vector<const definition*>& candidates);
+    static std::pmr::vector<const definition*>
+    best(std::pmr::vector<const definition*>& candidates);
+    static bool
+    is_in_image(const method& m, const definition& spec, std::size_t image);
     static bool is_more_specific(const definition* a, const definition* b);
     static bool is_base(const definition* a, const definition* b);
 
@@ -272,6 +345,9 @@ struct compiler : generic_compiler {
     static constexpr bool trace_enabled =
         Policy::template has_facet<policy::trace_output>;
     using indent = typename trace_type<Policy>::indent;
+
+    event_type<Policy> events{memory.get()};
+    static constexpr bool events_enabled = event_type<Policy>::events_enabled;
 };
 
 compiler() -> compiler<default_policy>;
@@ -296,6 +372,20 @@ auto compiler<Policy>::compile() {
     assign_slots();
     build_dispatch_tables();
 
+    report.allocations = memory->allocations;
+    report.allocated_bytes = memory->bytes;
+    ++trace << report.allocations << " allocations, " << report.allocated_bytes
+            << " bytes\n";
+
+    events(
+        "update", "cells", report.cells, "concrete_cells",
+        report.concrete_cells, "not_implemented", report.not_implemented,
+        "concrete_not_implemented", report.concrete_not_implemented,
+        "ambiguous", report.ambiguous, "concrete_ambiguous",
+        report.concrete_ambiguous, "simplified_methods",
+        report.simplified_methods, "allocations", report.allocations,
+        "allocated_bytes", report.allocated_bytes);
+
     compilation_done = true;
 
     return report;
@@ -351,6 +441,10 @@ void compiler<Policy>::resolve_static_type_ids() {
                                     resolve(&ti);
                                 }
 
+                                if (definition.overlay) {
+                                    resolve(&definition.overlay);
+                                }
+
                                 *definition.vp_end = 1;
                             }
                         }
@@ -380,7 +474,7 @@ void compiler<Policy>::augment_classes() {
             auto& rtc = class_map[Policy::type_index(cr.type)];
 
             if (rtc == nullptr) {
-                rtc = &classes.emplace_back();
+                rtc = &classes.emplace_back(memory.get());
                 rtc->is_abstract = cr.is_abstract;
                 rtc->static_vptr = cr.static_vptr;
             }
@@ -434,7 +528,7 @@ void compiler<Policy>::augment_classes() {
     std::size_t mark = ++class_mark;
 
     for (auto& rtc : classes) {
-        decltype(rtc.transitive_bases) bases;
+        decltype(rtc.transitive_bases) bases(memory.get());
         mark = ++class_mark;
 
         for (auto rtb : rtc.transitive_bases) {
@@ -486,6 +580,14 @@ void compiler<Policy>::augment_classes() {
         calculate_covariant_classes(rtc);
     }
 
+    if constexpr (events_enabled) {
+        for (auto& rtc : classes) {
+            events(
+                "class", "type", type_name(rtc.type_ids[0]), "bases",
+                range{rtc.direct_bases.begin(), rtc.direct_bases.end()});
+        }
+    }
+
     if constexpr (trace_enabled) {
         ++trace << "Inheritance lattice:\n";
 
@@ -528,7 +630,11 @@ void compiler<Policy>::augment_methods() {
     using namespace policy;
     using namespace detail;
 
-    methods.resize(Policy::methods.size());
+    methods.reserve(Policy::methods.size());
+
+    for (std::size_t i = Policy::methods.size(); i--;) {
+        methods.emplace_back(memory.get());
+    }
 
     ++trace << "Methods:\n";
     indent _(trace);
@@ -576,7 +682,12 @@ void compiler<Policy>::augment_methods() {
         meth_iter->not_implemented.method_index = method_index;
         meth_iter->not_implemented.spec_index = spec_size + 1;
 
-        meth_iter->specs.resize(spec_size);
+        meth_iter->specs.reserve(spec_size);
+
+        for (std::size_t i = spec_size; i--;) {
+            meth_iter->specs.emplace_back(memory.get());
+        }
+
         auto spec_iter = meth_iter->specs.begin();
 
         for (auto& definition_info : meth_info.specs) {
@@ -587,6 +698,22 @@ void compiler<Policy>::augment_methods() {
                     << definition_info.pf << ")\n";
             spec_iter->info = &definition_info;
             spec_iter->vp.reserve(meth_info.arity());
+
+            if constexpr (has_facet<Policy, overlay>) {
+                if (definition_info.overlay) {
+                    auto overlay_iter = std::find(
+                        overlays.begin(), overlays.end(),
+                        definition_info.overlay);
+
+                    if (overlay_iter == overlays.end()) {
+                        overlay_iter =
+                            overlays.insert(overlays.end(), definition_info.overlay);
+                    }
+
+                    spec_iter->image = overlay_iter - overlays.begin() + 1;
+                }
+            }
+
             std::size_t param_index = 0;
 
             for (auto type :
@@ -623,6 +750,23 @@ void compiler<Policy>::augment_methods() {
             vp->used_by_vp.push_back({&method, param_index++});
         }
     }
+
+    if constexpr (events_enabled) {
+        for (auto& method : methods) {
+            auto method_index = std::size_t(&method - &methods[0]);
+            events(
+                "method", "index", method_index, "name", method.info->name,
+                "type", type_name(method.info->method_type), "vp",
+                range{method.info->vp_begin, method.info->vp_end});
+
+            for (auto& spec : method.specs) {
+                events(
+                    "definition", "method", method_index, "index",
+                    spec.spec_index, "type", type_name(spec.info->type), "pf",
+                    spec.pf, "vp", range{spec.vp.begin(), spec.vp.end()});
+            }
+        }
+    }
 }
 
 template<class Policy>
@@ -663,7 +807,7 @@ void compiler<Policy>::assign_slots() {
 
             auto first_slot = cls.used_slots.find_first();
             cls.first_slot =
-                first_slot == boost::dynamic_bitset<>::npos ? 0 : first_slot;
+                first_slot == slot_set::npos ? 0 : first_slot;
             cls.vtbl.resize(cls.used_slots.size() - cls.first_slot);
             ++trace << cls << " vtbl: " << cls.first_slot << "-"
                     << cls.used_slots.size() << " slots " << cls.used_slots
@@ -681,6 +825,10 @@ void compiler<Policy>::assign_tree_slots(class_& cls, std::size_t base_slot) {
         ++trace << " in " << cls << " for "
                 << type_name(mp.method->info->method_type) << " parameter "
                 << mp.param << ": " << next_slot << "\n";
+        events(
+            "slot", "class", &cls, "method",
+            std::size_t(mp.method - &methods[0]), "param", mp.param, "slot",
+            next_slot);
         mp.method->slots[mp.param] = next_slot++;
     }
 
@@ -727,6 +875,10 @@ void compiler<Policy>::assign_lattice_slots(class_& cls) {
             ++trace << "first available slot: " << slot << "\n";
 
             mp.method->slots[mp.param] = slot;
+            events(
+                "slot", "class", &cls, "method",
+                std::size_t(mp.method - &methods[0]), "param", mp.param,
+                "slot", slot);
             detail::set_bit(cls.used_slots, slot);
             detail::set_bit(cls.reserved_slots, slot);
 
@@ -776,9 +928,9 @@ void compiler<Policy>::build_dispatch_tables() {
         indent _(trace);
 
         auto dims = m.arity();
+        m.overlay_dispatch_tables.resize(overlays.size());
 
-        std::vector<group_map> groups;
-        groups.resize(dims);
+        std::pmr::vector<group_map> groups(dims, memory.get());
 
         {
             std::size_t dim = 0;
@@ -850,6 +1002,11 @@ void compiler<Policy>::build_dispatch_tables() {
                     entry.group_index = group_num;
                 }
 
+                events(
+                    "group", "method", std::size_t(&m - &methods[0]), "dim",
+                    dim, "index", group_num, "mask", mask, "classes",
+                    range{group.classes.begin(), group.classes.end()});
+
                 ++group_num;
             }
         }
@@ -858,7 +1015,39 @@ void compiler<Policy>::build_dispatch_tables() {
             ++trace << "assigning specs\n";
             bitvec all(m.specs.size());
             all = ~all;
+
+            // Reserve the tables, to avoid wasting arena memory on growth.
+            std::size_t cells = 1;
+
+            for (const auto& dim_groups : groups) {
+                cells *= dim_groups.size();
+            }
+
+            m.dispatch_table.reserve(cells);
+
+            for (auto& table : m.overlay_dispatch_tables) {
+                table.reserve(cells);
+            }
+
             build_dispatch_table(m, dims - 1, groups.end() - 1, all, true);
+            events(
+                "table", "method", std::size_t(&m - &methods[0]), "cells",
+                range{m.dispatch_table.begin(), m.dispatch_table.end()});
+
+            // The shortcuts read the regular dispatch table, and the checks
+            // are made while reading the vptrs of all the arguments.
+            if constexpr (!Policy::template has_facet<
+                              policy::runtime_checks>) {
+                if (m.arity() > 1 && overlays.empty()) {
+                    find_decisive_vp(m, groups);
+                }
+            }
+
+            if constexpr (Policy::template has_facet<policy::morton_order>) {
+                if (m.arity() > 1) {
+                    make_morton_order(m, groups);
+                }
+            }
 
             if (m.arity() > 1) {
                 indent _(trace);
@@ -890,10 +1079,18 @@ void compiler<Policy>::build_dispatch_tables() {
             }
 
             print(m.report);
+            events(
+                "report", "method", std::size_t(&m - &methods[0]), "cells",
+                m.report.cells, "concrete_cells", m.report.concrete_cells,
+                "not_implemented", m.report.not_implemented,
+                "concrete_not_implemented", m.report.concrete_not_implemented,
+                "ambiguous", m.report.ambiguous, "concrete_ambiguous",
+                m.report.concrete_ambiguous);
             accumulate(m.report, report);
             ++trace << "assigning next\n";
 
-            std::vector<const definition*> specs;
+            std::pmr::vector<const definition*> specs(memory.get());
+            std::pmr::vector<const definition*> candidates(memory.get());
             std::transform(
                 m.specs.begin(), m.specs.end(), std::back_inserter(specs),
                 [](const definition& spec) { return &spec; });
@@ -901,11 +1098,12 @@ void compiler<Policy>::build_dispatch_tables() {
             for (auto& spec : m.specs) {
                 indent _(trace);
                 ++trace << type_name(spec.info->type) << ":\n";
-                std::vector<const definition*> candidates;
+                candidates.clear();
                 std::copy_if(
                     specs.begin(), specs.end(), std::back_inserter(candidates),
-                    [&spec](const definition* other) {
-                        return is_base(other, &spec);
+                    [&m, &spec](const definition* other) {
+                        return is_base(other, &spec) &&
+                            is_in_image(m, *other, spec.image);
                     });
 
                 if constexpr (trace_enabled) {
@@ -939,6 +1137,13 @@ void compiler<Policy>::build_dispatch_tables() {
                 if (spec.info->next) {
                     *spec.info->next = next;
                 }
+
+                events(
+                    "next", "method", std::size_t(&m - &methods[0]),
+                    "definition", spec.spec_index, "next",
+                    nexts.size() == 1 ? nexts.front()->spec_index
+                        : nexts.empty() ? m.not_implemented.spec_index
+                                        : m.ambiguous.spec_index);
             }
         }
     }
@@ -947,12 +1152,13 @@ void compiler<Policy>::build_dispatch_tables() {
 template<class Policy>
 void compiler<Policy>::build_dispatch_table(
     method& m, std::size_t dim,
-    std::vector<group_map>::const_iterator group_iter, const bitvec& candidates,
-    bool concrete) {
+    std::pmr::vector<group_map>::const_iterator group_iter,
+    const bitvec& candidates, bool concrete) {
     using namespace detail;
 
     indent _(trace);
     std::size_t group_index = 0;
+    std::pmr::vector<const definition*> applicable(memory.get());
 
     for (const auto& [group_mask, group] : *group_iter) {
         auto mask = candidates & group_mask;
@@ -967,11 +1173,11 @@ void compiler<Policy>::build_dispatch_table(
         }
 
         if (dim == 0) {
-            std::vector<const definition*> applicable;
+            applicable.clear();
             std::size_t i = 0;
 
             for (const auto& spec : m.specs) {
-                if (mask[i]) {
+                if (mask[i] && is_in_image(m, spec, 0)) {
                     applicable.push_back(&spec);
                 }
                 ++i;
@@ -1012,6 +1218,26 @@ void compiler<Policy>::build_dispatch_table(
                         << type_name(spec->info->type)
                         << " pf = " << spec->info->pf << "\n";
             }
+
+            // The overlays use the same groups, thus their dispatch tables
+            // have the same layout. Only the selected definitions differ.
+            for (std::size_t image = 1; image <= overlays.size(); ++image) {
+                applicable.clear();
+                i = 0;
+
+                for (const auto& spec : m.specs) {
+                    if (mask[i] && is_in_image(m, spec, image)) {
+                        applicable.push_back(&spec);
+                    }
+                    ++i;
+                }
+
+                auto specs = best(applicable);
+                m.overlay_dispatch_tables[image - 1].push_back(
+                    specs.size() > 1 ? &m.ambiguous
+                        : specs.empty() ? &m.not_implemented
+                                        : specs[0]);
+            }
         } else {
             build_dispatch_table(
                 m, dim - 1, group_iter - 1, mask,
@@ -1021,6 +1247,130 @@ void compiler<Policy>::build_dispatch_table(
     }
 }
 
+template<class Policy>
+void compiler<Policy>::find_decisive_vp(
+    method& m, const std::pmr::vector<group_map>& groups) {
+    auto& table = m.dispatch_table;
+
+    if (std::all_of(table.begin(), table.end(), [&table](auto spec) {
+            return spec->pf == table[0]->pf;
+        })) {
+        ++trace << "simplified: constant\n";
+        m.decisive_vp = m.arity();
+        events(
+            "simplified", "method", std::size_t(&m - &methods[0]), "vp",
+            m.decisive_vp);
+        ++report.simplified_methods;
+
+        return;
+    }
+
+    // If the cells only depend on the group of one of the arguments, they
+    // contain the same definition as the cell in the same group for that
+    // argument, and the first group for the others.
+    for (std::size_t dim = 0, stride = 1; dim < m.arity();
+         stride *= groups[dim].size(), ++dim) {
+        bool decisive = true;
+
+        for (std::size_t cell = 0; decisive && cell < table.size(); ++cell) {
+            auto projection = cell / stride % groups[dim].size() * stride;
+            decisive = table[cell]->pf == table[projection]->pf;
+        }
+
+        if (decisive) {
+            ++trace << "simplified: depends only on vp #" << dim << "\n";
+            m.decisive_vp = dim;
+            events(
+                "simplified", "method", std::size_t(&m - &methods[0]), "vp",
+                m.decisive_vp);
+            ++report.simplified_methods;
+
+            return;
+        }
+    }
+}
+
+template<class Policy>
+void compiler<Policy>::make_morton_order(
+    method& m, const std::pmr::vector<group_map>& groups) {
+    using namespace detail;
+
+    // Interleave the bits of the group indexes, one bit of each dimension at
+    // a time, so cells that are close in all the dimensions are close in
+    // memory. Each dimension is padded to a power of two.
+    auto dims = m.arity();
+    std::pmr::vector<std::pmr::vector<std::size_t>> positions(
+        dims, memory.get());
+    std::size_t table_bits = 0;
+
+    for (std::size_t level = 0, more = 1; more; ++level) {
+        more = 0;
+
+        for (std::size_t dim = 0; dim < dims; ++dim) {
+            if ((std::size_t(1) << level) < groups[dim].size()) {
+                positions[dim].push_back(table_bits++);
+                more = 1;
+            }
+        }
+    }
+
+    auto spread = [&positions](std::size_t dim, std::size_t group_index) {
+        std::size_t index = 0;
+
+        for (std::size_t bit = 0; bit < positions[dim].size(); ++bit) {
+            if (group_index & (std::size_t(1) << bit)) {
+                index |= std::size_t(1) << positions[dim][bit];
+            }
+        }
+
+        return index;
+    };
+
+    ++trace << "Morton order: " << (std::size_t(1) << table_bits)
+            << " cells\n";
+
+    std::pmr::vector<const definition*> table(
+        std::size_t(1) << table_bits, &m.not_implemented, memory.get());
+    std::pmr::vector<std::pmr::vector<const definition*>> overlay_tables(
+        m.overlay_dispatch_tables.size(), table, memory.get());
+
+    for (std::size_t cell = 0; cell < m.dispatch_table.size(); ++cell) {
+        std::size_t rest = cell, index = 0;
+
+        for (std::size_t dim = 0; dim < dims; ++dim) {
+            index |= spread(dim, rest % groups[dim].size());
+            rest /= groups[dim].size();
+        }
+
+        table[index] = m.dispatch_table[cell];
+
+        for (std::size_t image = 0; image < overlay_tables.size(); ++image) {
+            overlay_tables[image][index] =
+                m.overlay_dispatch_tables[image][cell];
+        }
+    }
+
+    m.dispatch_table.swap(table);
+    m.overlay_dispatch_tables.swap(overlay_tables);
+
+    // The bits of the indexes are disjoint, so they are simply added. Set the
+    // strides to 1, for code that multiplies anyway.
+    std::fill(m.strides.begin(), m.strides.end(), 1);
+
+    for (std::size_t dim = 0; dim < dims; ++dim) {
+        std::size_t group_index = 0;
+
+        for (auto& [mask, group] : groups[dim]) {
+            for (auto cls : group.classes) {
+                cls->vtbl[m.slots[dim] - cls->first_slot].group_index =
+                    spread(dim, group_index);
+            }
+
+            ++group_index;
+        }
+    }
+}
+
 inline void generic_compiler::accumulate(
     const update_method_report& partial, update_report& total) {
     total.cells += partial.cells;
@@ -1042,11 +1392,53 @@ void compiler<Policy>::install_gv() {
         classes.begin(), classes.end(), dispatch_data_size,
         [](auto sum, auto& cls) { return sum + cls.vtbl.size(); });
 
+    auto image_size = dispatch_data_size;
+
+    if constexpr (has_facet<Policy, overlay>) {
+        dispatch_data_size *= 1 + overlays.size();
+    }
+
+    auto slots_strides_offset = dispatch_data_size;
+    constexpr std::size_t cache_line_cells = 64 / sizeof(std::uintptr_t);
+
+    if constexpr (has_facet<Policy, packed_slots>) {
+        static_assert(sizeof(std::size_t) == sizeof(std::uintptr_t));
+
+        // Make room for the slots and strides of all the methods, after the
+        // v-tables, plus slack to align them on a cache line.
+        dispatch_data_size = std::accumulate(
+            methods.begin(), methods.end(),
+            dispatch_data_size + cache_line_cells - 1,
+            [](auto sum, auto& m) { return sum + 2 * m.arity() - 1; });
+    }
+
     Policy::dispatch_data.resize(dispatch_data_size);
     auto gv_first = Policy::dispatch_data.data();
     auto gv_last = gv_first + Policy::dispatch_data.size();
     auto gv_iter = gv_first;
 
+    if constexpr (has_facet<Policy, packed_slots>) {
+        auto slots_strides_iter = gv_first + slots_strides_offset;
+        auto misalignment =
+            reinterpret_cast<std::uintptr_t>(slots_strides_iter) %
+            (cache_line_cells * sizeof(std::uintptr_t));
+
+        if (misalignment) {
+            slots_strides_iter +=
+                cache_line_cells - misalignment / sizeof(std::uintptr_t);
+        }
+
+        ++trace << "Packing slots and strides at " << slots_strides_iter
+                << "\n";
+
+        for (auto& m : methods) {
+            m.info->slots_strides_ptr =
+                reinterpret_cast<std::size_t*>(slots_strides_iter);
+            slots_strides_iter += 2 * m.arity() - 1;
+            BOOST_ASSERT(slots_strides_iter <= gv_last);
+        }
+    }
+
     ++trace << "Initializing multi-method dispatch tables at " << gv_iter
             << "\n";
 
@@ -1076,6 +1468,8 @@ void compiler<Policy>::install_gv() {
         }
 
         m.gv_dispatch_table = gv_iter;
+        m.info->dispatch_table = gv_iter;
+        m.info->decisive_vp = m.decisive_vp;
         BOOST_ASSERT(gv_iter + m.dispatch_table.size() <= gv_last);
         gv_iter = std::transform(
             m.dispatch_table.begin(), m.dispatch_table.end(), gv_iter,
@@ -1132,15 +1526,63 @@ void compiler<Policy>::install_gv() {
     ++trace << rflush(4, Policy::dispatch_data.size()) << " " << gv_iter
             << " end\n";
 
+    if constexpr (has_facet<Policy, overlay>) {
+        // Each overlay gets a copy of the tables, at a fixed distance from
+        // the regular ones. Patch the cells that differ.
+        Policy::overlay_types.assign(overlays.begin(), overlays.end());
+        Policy::overlay_image_size = image_size;
+
+        for (std::size_t image = 1; image <= overlays.size(); ++image) {
+            auto image_offset = image * image_size;
+            ++trace << "Initializing overlay " << type_name(overlays[image - 1])
+                    << " at " << gv_first + image_offset << "\n";
+            std::copy(gv_first, gv_first + image_size, gv_first + image_offset);
+
+            for (auto& m : methods) {
+                if (m.arity() > 1) {
+                    auto& table = m.overlay_dispatch_tables[image - 1];
+                    std::transform(
+                        table.begin(), table.end(),
+                        gv_first + (m.gv_dispatch_table - gv_first) +
+                            image_offset,
+                        [](auto spec) { return spec->pf; });
+                }
+            }
+
+            for (auto& cls : classes) {
+                auto vtbl = *cls.static_vptr + image_offset;
+
+                for (std::size_t i = 0; i < cls.vtbl.size(); ++i) {
+                    auto& entry = cls.vtbl[i];
+                    auto& method = methods[entry.method_index];
+                    auto& cell = vtbl[cls.first_slot + i];
+
+                    if (method.arity() == 1) {
+                        cell = method.overlay_dispatch_tables[image - 1]
+                                                             [entry.group_index]
+                                                                 ->pf;
+                    } else if (entry.vp_index == 0) {
+                        cell += image_offset * sizeof(std::uintptr_t);
+                    }
+                }
+            }
+        }
+    }
+
     if constexpr (has_facet<Policy, external_vptr>) {
         Policy::publish_vptrs(classes.begin(), classes.end());
     }
+
+    if constexpr (has_facet<Policy, generation_vptr>) {
+        // Invalidate the vptrs cached in virtual_ptrs.
+        ++Policy::vptr_generation;
+    }
 }
 
 template<class Policy>
-std::vector<const generic_compiler::definition*>
-compiler<Policy>::best(std::vector<const definition*>& candidates) {
-    std::vector<const definition*> best;
+std::pmr::vector<const generic_compiler::definition*>
+compiler<Policy>::best(std::pmr::vector<const definition*>& candidates) {
+    std::pmr::vector<const definition*> best(candidates.get_allocator());
 
     for (auto spec : candidates) {
         const definition* candidate = spec;
@@ -1207,6 +1649,26 @@ bool compiler<Policy>::is_base(const definition* a, const definition* b) {
     return result;
 }
 
+template<class Policy>
+bool compiler<Policy>::is_in_image(
+    const method& m, const definition& spec, std::size_t image) {
+    if (spec.image == image) {
+        return true;
+    }
+
+    if (spec.image != 0) {
+        return false;
+    }
+
+    // A regular definition is part of an overlay, unless the overlay
+    // overrides it, i.e. contains a definition with the same virtual
+    // parameters.
+    return std::none_of(
+        m.specs.begin(), m.specs.end(), [&spec, image](const auto& other) {
+            return other.image == image && other.vp == spec.vp;
+        });
+}
+
 template<class Policy>
 void compiler<Policy>::print(const update_method_report& report) const {
     ++trace;
@@ -0,0 +1,193 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_DETAIL_EVENTS_HPP
+#define YOREL_YOMM2_DETAIL_EVENTS_HPP
+
+#include <yorel/yomm2/detail/trace.hpp>
+
+#include <charconv>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include <boost/dynamic_bitset.hpp>
+
+namespace yorel {
+namespace yomm2 {
+namespace detail {
+
+// Writes the decisions made by the compiler as JSON lines, one object per
+// event, to the stream of the 'event_output' facet. Type names are interned:
+// each name is computed and written once, in a "type" event, and the type is
+// subsequently referred to by number.
+template<class Policy>
+struct event_type {
+    static constexpr bool events_enabled =
+        Policy::template has_facet<policy::event_output>;
+
+    std::pmr::unordered_map<type_id, std::size_t> types;
+    std::pmr::string line, type_line;
+
+    explicit event_type(std::pmr::memory_resource* memory)
+        : types(memory), line(memory), type_line(memory) {
+    }
+
+    // Write an event, followed by key/value pairs.
+    template<typename... Fields>
+    void operator()(const char* event, const Fields&... fields) {
+        if constexpr (events_enabled) {
+            if (!Policy::events_enabled) {
+                return;
+            }
+
+            line.assign("{\"event\":\"");
+            line += event;
+            line += '"';
+            write_fields(fields...);
+            line += "}\n";
+            Policy::event_stream << std::string_view(line);
+        }
+    }
+
+    void write_fields() {
+    }
+
+    template<typename Value, typename... More>
+    void
+    write_fields(const char* key, const Value& value, const More&... more) {
+        line += ",\"";
+        line += key;
+        line += "\":";
+        write(line, value);
+        write_fields(more...);
+    }
+
+    static void write(std::pmr::string& out, std::size_t value) {
+        char str[20];
+        auto end = std::to_chars(str, str + sizeof(str), value).ptr;
+        out.append(str, end);
+    }
+
+    static void write(std::pmr::string& out, std::string_view str) {
+        out += '"';
+
+        for (auto c : str) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                const char* digits = "0123456789abcdef";
+                out += "\\u00";
+                out += digits[c >> 4];
+                out += digits[c & 0xf];
+            } else {
+                out += c;
+            }
+        }
+
+        out += '"';
+    }
+
+    static void write(std::pmr::string& out, const char* str) {
+        write(out, std::string_view(str));
+    }
+
+    static void
+    write(std::pmr::string& out, const boost::dynamic_bitset<>& bits) {
+        out += '"';
+
+        for (auto i = bits.size(); i != 0;) {
+            out += bits[--i] ? '1' : '0';
+        }
+
+        out += '"';
+    }
+
+    void write(std::pmr::string& out, const type_name& manip) {
+        write(out, intern(manip.type));
+    }
+
+    // generic_compiler::class_
+    template<class Class>
+    auto write(std::pmr::string& out, const Class* cls)
+        -> decltype(cls->type_ids, void()) {
+        write(out, type_name(cls->type_ids[0]));
+    }
+
+    // generic_compiler::definition
+    template<class Definition>
+    auto write(std::pmr::string& out, const Definition* def)
+        -> decltype(def->spec_index, void()) {
+        write(out, def->spec_index);
+    }
+
+    void write(std::pmr::string& out, const range<type_id*>& types) {
+        write_array(out, types, [](auto type) { return type_name(type); });
+    }
+
+    template<typename Iterator>
+    void write(std::pmr::string& out, const range<Iterator>& values) {
+        write_array(out, values, [](const auto& value) { return value; });
+    }
+
+    template<typename Iterator, typename F>
+    void
+    write_array(std::pmr::string& out, const range<Iterator>& values, F fn) {
+        out += '[';
+        const char* sep = "";
+
+        for (const auto& value : values) {
+            out += sep;
+            write(out, fn(value));
+            sep = ",";
+        }
+
+        out += ']';
+    }
+
+    // Collects the output of 'Policy::type_name'.
+    struct name_stream {
+        std::pmr::string& str;
+
+        template<typename T>
+        name_stream& operator<<(const T& value) {
+            if constexpr (std::is_arithmetic_v<T>) {
+                write(str, std::size_t(value));
+            } else {
+                str += value;
+            }
+
+            return *this;
+        }
+    };
+
+    std::size_t intern(type_id type) {
+        auto [iter, inserted] = types.try_emplace(type, types.size());
+
+        if (inserted) {
+            std::pmr::string name(types.get_allocator().resource());
+            name_stream stream{name};
+            Policy::type_name(type, stream);
+
+            type_line.assign("{\"event\":\"type\",\"id\":");
+            write(type_line, iter->second);
+            type_line += ",\"name\":";
+            write(type_line, std::string_view(name));
+            type_line += "}\n";
+            Policy::event_stream << std::string_view(type_line);
+        }
+
+        return iter->second;
+    }
+};
+
+} // namespace detail
+} // namespace yomm2
+} // namespace yorel
+
+#endif
@@ -112,9 +112,10 @@ auto& operator<<(trace_type<Policy>& trace, const rflush& rf) {
     return trace;
 }
 
-template<class Policy>
+template<class Policy, typename Block, class Allocator>
 auto& operator<<(
-    trace_type<Policy>& trace, const boost::dynamic_bitset<>& bits) {
+    trace_type<Policy>& trace,
+    const boost::dynamic_bitset<Block, Allocator>& bits) {
     if constexpr (trace_type<Policy>::trace_enabled) {
         if (Policy::trace_enabled) {
             if (Policy::trace_enabled) {
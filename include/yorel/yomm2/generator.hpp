@@ -11,12 +11,15 @@
 
 #include <boost/core/demangle.hpp>
 
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <numeric>
-#include <regex>
 #include <set>
+#include <sstream>
 
 namespace yorel {
 namespace yomm2 {
@@ -41,6 +44,8 @@ class generator {
     static void encode_dispatch_data(
         const Compiler& compiler, const std::string& policy, std::ostream& os);
 
+    class output_file;
+
   private:
     void write_static_offsets(
         const detail::method_info& method, std::ostream& os) const;
@@ -75,6 +80,72 @@ inline bool starts_with(std::string_view name, const char* prefix) {
 
 } // namespace detail
 
+// Collects generated code, and writes it to a file when closed - but only if
+// it changed, so the files that include it are not recompiled needlessly. The
+// first line of the file contains a hash of the code, thus only that line is
+// read from the existing file.
+class generator::output_file : public std::ostringstream {
+  public:
+    explicit output_file(std::string path);
+    ~output_file();
+
+    // Returns true if the file was (re)written. Subsequent calls return the
+    // same value.
+    bool close();
+
+    const std::string path;
+    bool written = false;
+    // Time between construction and 'close'.
+    std::chrono::steady_clock::duration elapsed{};
+
+  private:
+    std::chrono::steady_clock::time_point start;
+    bool closed = false;
+};
+
+inline generator::output_file::output_file(std::string path)
+    : path(std::move(path)), start(std::chrono::steady_clock::now()) {
+}
+
+inline generator::output_file::~output_file() {
+    close();
+}
+
+inline bool generator::output_file::close() {
+    if (closed) {
+        return written;
+    }
+
+    closed = true;
+    auto code = str();
+
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325;
+
+    for (auto c : code) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+
+    char header[64];
+    std::snprintf(
+        header, sizeof(header), "// yomm2 generator hash: %016llx",
+        static_cast<unsigned long long>(hash));
+
+    std::string line;
+    std::ifstream existing(path);
+
+    if (!(std::getline(existing, line) && line == header)) {
+        existing.close();
+        std::ofstream file(path);
+        file << header << "\n" << code;
+        written = true;
+    }
+
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    return written;
+}
+
 // clang-format off
 inline std::unordered_set<std::string_view> generator::keywords = {
     "void",   "bool",  "char", "int",    "float",
@@ -88,25 +159,49 @@ inline std::unordered_set<std::string_view> generator::keywords = {
 inline generator& generator::add_forward_declaration(std::string_view type) {
     using namespace detail;
 
-    std::regex name_regex(R"((\w+(?:::\w+)*)( *<)?)");
+    // Extract qualified names - words separated by '::' - that are not followed
+    // by a '<', i.e. not templates. A hand-written scanner is much faster than
+    // a std::regex, which matters when demangling many types.
+    auto is_word = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
 
-    auto iter = std::regex_iterator(type.begin(), type.end(), name_regex);
-    auto words_end = std::sregex_iterator();
+    auto iter = type.begin(), last = type.end();
 
-    for (decltype(iter) last; iter != last; ++iter) {
-        if ((*iter)[2].matched) {
+    while (iter != last) {
+        if (!is_word(*iter)) {
+            ++iter;
             continue;
         }
 
-        auto match = (*iter)[1];
+        auto first = iter;
 
-        if (!match.matched) {
-            continue;
+        while (true) {
+            while (iter != last && is_word(*iter)) {
+                ++iter;
+            }
+
+            if (last - iter > 2 && iter[0] == ':' && iter[1] == ':' &&
+                is_word(iter[2])) {
+                iter += 2;
+            } else {
+                break;
+            }
         }
 
-        std::string_view name(&*match.first, match.length());
+        std::string_view name(&*first, iter - first);
+        auto after = iter;
+
+        while (after != last && *after == ' ') {
+            ++after;
+        }
+
+        if (after != last && *after == '<') {
+            iter = after + 1;
+            continue;
+        }
 
-        if (!std::isalpha(*match.first)) {
+        if (!std::isalpha(static_cast<unsigned char>(name[0]))) {
             continue;
         }
 
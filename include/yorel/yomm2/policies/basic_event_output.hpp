@@ -0,0 +1,32 @@
+
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_POLICY_BASIC_EVENT_OUTPUT_HPP
+#define YOREL_YOMM2_POLICY_BASIC_EVENT_OUTPUT_HPP
+
+#include <yorel/yomm2/policies/core.hpp>
+
+namespace yorel {
+namespace yomm2 {
+namespace policy {
+
+template<class Policy, typename Stream = detail::ostderr>
+struct yOMM2_API_gcc basic_event_output : virtual event_output {
+    static Stream event_stream;
+    static bool events_enabled;
+};
+
+template<class Policy, typename Stream>
+Stream basic_event_output<Policy, Stream>::event_stream;
+
+template<class Policy, typename Stream>
+bool basic_event_output<Policy, Stream>::events_enabled = true;
+
+}
+}
+}
+
+#endif
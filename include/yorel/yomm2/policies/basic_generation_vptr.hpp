@@ -0,0 +1,91 @@
+
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_POLICY_BASIC_GENERATION_VPTR_HPP
+#define YOREL_YOMM2_POLICY_BASIC_GENERATION_VPTR_HPP
+
+#include <atomic>
+
+#include <yorel/yomm2/policies/basic_indirect_vptr.hpp>
+
+namespace yorel {
+namespace yomm2 {
+
+namespace policy {
+
+template<class Policy>
+struct yOMM2_API_gcc basic_generation_vptr : virtual generation_vptr,
+                                             basic_indirect_vptr<Policy> {
+    // Incremented by update().
+    static std::size_t vptr_generation;
+};
+
+template<class Policy>
+std::size_t basic_generation_vptr<Policy>::vptr_generation;
+
+} // namespace policy
+
+namespace detail {
+
+// The vptr stored in a virtual_ptr, for policies with a generation_vptr facet:
+// a pointer to the vptr, which survives update(), and a copy of the vptr,
+// valid as long as the generation has not changed.
+template<class Policy>
+class generation_checked_vptr {
+    std::uintptr_t const* const* indirect = nullptr;
+    mutable std::atomic<std::uintptr_t const*> direct{nullptr};
+    mutable std::atomic<std::size_t> generation{0};
+
+  public:
+    generation_checked_vptr() = default;
+
+    generation_checked_vptr(std::uintptr_t const* const* indirect)
+        : indirect(indirect), direct(*indirect),
+          generation(Policy::vptr_generation) {
+    }
+
+    generation_checked_vptr(const generation_checked_vptr& other)
+        : indirect(other.indirect),
+          direct(other.direct.load(std::memory_order_relaxed)),
+          generation(other.generation.load(std::memory_order_relaxed)) {
+    }
+
+    generation_checked_vptr& operator=(const generation_checked_vptr& other) {
+        indirect = other.indirect;
+        // Store the generation last, see get().
+        direct.store(
+            other.direct.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        generation.store(
+            other.generation.load(std::memory_order_relaxed),
+            std::memory_order_release);
+
+        return *this;
+    }
+
+    std::uintptr_t const* const* indirect_vptr() const noexcept {
+        return indirect;
+    }
+
+    const std::uintptr_t* get() const noexcept {
+        auto current = Policy::vptr_generation;
+
+        if (BOOST_UNLIKELY(
+                generation.load(std::memory_order_acquire) != current)) {
+            direct.store(*indirect, std::memory_order_relaxed);
+            generation.store(current, std::memory_order_release);
+        }
+
+        return direct.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace detail
+
+} // namespace yomm2
+} // namespace yorel
+
+#endif
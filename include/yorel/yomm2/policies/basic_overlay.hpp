@@ -0,0 +1,52 @@
+
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_POLICY_BASIC_OVERLAY_HPP
+#define YOREL_YOMM2_POLICY_BASIC_OVERLAY_HPP
+
+#include <yorel/yomm2/policies/core.hpp>
+
+namespace yorel {
+namespace yomm2 {
+namespace policy {
+
+template<class Policy>
+struct yOMM2_API_gcc basic_overlay : virtual overlay {
+    // Distance, in dispatch_data cells, between the regular tables and the
+    // tables of the overlay selected by the current thread.
+    static thread_local std::ptrdiff_t overlay_offset;
+
+    // Filled by update(): the overlays, in the order of their images in
+    // dispatch_data, and the size of an image.
+    static std::vector<type_id> overlay_types;
+    static std::size_t overlay_image_size;
+
+    static std::ptrdiff_t overlay_image_offset(type_id overlay) {
+        auto iter =
+            std::find(overlay_types.begin(), overlay_types.end(), overlay);
+
+        if (iter == overlay_types.end()) {
+            return 0;
+        }
+
+        return (iter - overlay_types.begin() + 1) * overlay_image_size;
+    }
+};
+
+template<class Policy>
+thread_local std::ptrdiff_t basic_overlay<Policy>::overlay_offset;
+
+template<class Policy>
+std::vector<type_id> basic_overlay<Policy>::overlay_types;
+
+template<class Policy>
+std::size_t basic_overlay<Policy>::overlay_image_size;
+
+}
+}
+}
+
+#endif
@@ -56,6 +56,7 @@ struct definition_info : static_list<definition_info>::static_link {
     void** next;
     type_id *vp_begin, *vp_end;
     void* pf;
+    type_id overlay; // 0 for regular definitions
 };
 
 template<class Key>
@@ -79,9 +80,18 @@ struct domain {};
 template<class Class, class Policy>
 struct virtual_ptr;
 
+template<class Class, std::size_t Size, std::size_t Align, class Policy>
+class virtual_value;
+
 template<typename T>
 struct virtual_;
 
+template<typename Enum>
+struct enum_tag;
+
+template<typename Enum, Enum Value>
+struct enum_value;
+
 template<class Policy, typename Key, typename Signature>
 struct method;
 
@@ -148,11 +158,17 @@ struct abstract_policy {};
 struct error_handler {};
 struct runtime_checks {};
 struct indirect_vptr {};
+struct generation_vptr : virtual indirect_vptr {};
 struct type_hash {};
 struct vptr_placement {};
 struct external_vptr : virtual vptr_placement {};
+struct nearest_base {};
 struct error_output {};
 struct trace_output {};
+struct event_output {};
+struct overlay {};
+struct packed_slots {};
+struct morton_order {};
 
 struct deferred_static_rtti;
 struct debug;
@@ -65,6 +65,48 @@ void fast_perfect_hash<Policy>::hash_initialize(
         }
     }
 
+    if (hash_mult) {
+        // Try the current factors first. If they are still collision-free -
+        // typically, when a few classes were added by a dynamic library - the
+        // indices of the classes that were already known do not change, and
+        // no search is needed.
+        buckets.assign(
+            std::size_t(1) << (8 * sizeof(type_id) - hash_shift),
+            static_cast<type_id>(-1));
+        bool found = true;
+        std::size_t max = 0;
+
+        for (auto iter = first; found && iter != last; ++iter) {
+            for (auto type_iter = iter->type_id_begin();
+                 type_iter != iter->type_id_end(); ++type_iter) {
+                auto type = *type_iter;
+                auto index = (type * hash_mult) >> hash_shift;
+
+                if (buckets[index] != static_cast<type_id>(-1)) {
+                    found = false;
+                    break;
+                }
+
+                buckets[index] = type;
+                max = (std::max)(max, index);
+            }
+        }
+
+        if (found) {
+            hash_max = max;
+            hash_length = hash_max + 1;
+
+            if constexpr (trace_enabled) {
+                if (Policy::trace_enabled) {
+                    Policy::trace_stream << "  reusing " << hash_mult
+                                         << "; max = " << hash_max << "\n";
+                }
+            }
+
+            return;
+        }
+    }
+
     std::default_random_engine rnd(13081963);
     std::size_t total_attempts = 0;
     std::size_t M = 1;
@@ -10,6 +10,7 @@
 #include <yorel/yomm2/policies/core.hpp>
 
 #ifndef BOOST_NO_RTTI
+#include <any>
 #include <typeindex>
 #include <typeinfo>
 #include <boost/core/demangle.hpp>
@@ -33,6 +34,11 @@ struct std_rtti : virtual rtti {
         return reinterpret_cast<type_id>(tip);
     }
 
+    static type_id dynamic_type(const std::any& obj) {
+        auto tip = &obj.type();
+        return reinterpret_cast<type_id>(tip);
+    }
+
     template<typename Stream>
     static void type_name(type_id type, Stream& stream) {
         stream << boost::core::demangle(
@@ -0,0 +1,253 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_POLICY_VPTR_NEAREST_BASE_HPP
+#define YOREL_YOMM2_POLICY_VPTR_NEAREST_BASE_HPP
+
+#include <yorel/yomm2/policies/vptr_vector.hpp>
+#include <yorel/yomm2/policies/std_rtti.hpp>
+
+#include <atomic>
+
+#if !defined(BOOST_NO_RTTI) && __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define YOMM2_ITANIUM_RTTI
+#endif
+
+namespace yorel {
+namespace yomm2 {
+namespace policy {
+
+template<class Policy>
+struct yOMM2_API_gcc vptr_nearest_base : virtual nearest_base,
+                                         vptr_vector<Policy> {
+    static constexpr std::size_t nearest_base_cache_size = 1024;
+    static constexpr std::size_t nearest_base_cache_probes = 8;
+
+    // Entries are keyed on the dynamic type and the static type of the
+    // argument.
+    struct cache_entry {
+        std::atomic<type_id> type;
+        std::atomic<type_id> static_type;
+        std::atomic<type_id> base; // 0 while being filled
+    };
+
+    // registered class at each index in 'vptrs'
+    static std::vector<type_id> vptr_types;
+    static cache_entry nearest_base_cache[nearest_base_cache_size];
+
+    template<typename ForwardIterator>
+    static void publish_vptrs(ForwardIterator first, ForwardIterator last) {
+        static_assert(
+            !has_facet<Policy, indirect_vptr>,
+            "vptr_nearest_base cannot be combined with indirect_vptr");
+
+        vptr_vector<Policy>::publish_vptrs(first, last);
+
+        vptr_types.assign(vptr_vector<Policy>::vptrs.size(), 0);
+
+        for (auto iter = first; iter != last; ++iter) {
+            for (auto type_iter = iter->type_id_begin();
+                 type_iter != iter->type_id_end(); ++type_iter) {
+                vptr_types[hash(*type_iter)] = *type_iter;
+            }
+        }
+
+        // The set of registered classes may have changed.
+        for (auto& entry : nearest_base_cache) {
+            entry.type.store(0, std::memory_order_relaxed);
+            entry.static_type.store(0, std::memory_order_relaxed);
+            entry.base.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    template<class Class>
+    static const std::uintptr_t* dynamic_vptr(const Class& arg) {
+        return type_vptr(
+            Policy::dynamic_type(arg), Policy::template static_type<Class>());
+    }
+
+    // 'static_type' is the static type of the argument: only the bases that
+    // derive from it are considered.
+    static const std::uintptr_t* type_vptr(type_id type, type_id static_type) {
+        auto index = hash(type);
+
+        if (index < vptr_types.size() && vptr_types[index] == type) {
+            return vptr_vector<Policy>::vptrs[index];
+        }
+
+        return vptr_vector<Policy>::vptrs[hash(
+            cached_nearest_base(type, static_type))];
+    }
+
+  private:
+    static std::size_t hash(type_id type) {
+        if constexpr (has_facet<Policy, type_hash>) {
+            return Policy::hash_type_id(type);
+        } else {
+            return type;
+        }
+    }
+
+    static bool is_registered(type_id type) {
+        auto index = hash(type);
+
+        return index < vptr_types.size() && vptr_types[index] == type;
+    }
+
+    static type_id cached_nearest_base(type_id type, type_id static_type);
+    static type_id find_nearest_base(type_id type, type_id static_type);
+#ifdef YOMM2_ITANIUM_RTTI
+    static bool derives_from(
+        const std::type_info* type, const std::type_info* base);
+#endif
+};
+
+template<class Policy>
+type_id vptr_nearest_base<Policy>::cached_nearest_base(
+    type_id type, type_id static_type) {
+    constexpr auto mask = nearest_base_cache_size - 1;
+
+    auto first = ((type >> 3) ^ (static_type >> 5)) & mask;
+
+    for (std::size_t probe = 0; probe < nearest_base_cache_probes;
+         ++probe) {
+        auto& entry = nearest_base_cache[(first + probe) & mask];
+        auto entry_type = entry.type.load(std::memory_order_acquire);
+
+        if (entry_type == type) {
+            auto base = entry.base.load(std::memory_order_acquire);
+
+            if (!base) {
+                break; // being filled by another thread
+            }
+
+            // 'static_type' is written before 'base'.
+            if (entry.static_type.load(std::memory_order_relaxed) ==
+                static_type) {
+                return base;
+            }
+
+            continue; // same dynamic type, other static type
+        }
+
+        if (entry_type == 0) {
+            break;
+        }
+    }
+
+    auto base = find_nearest_base(type, static_type);
+
+    for (std::size_t probe = 0; probe < nearest_base_cache_probes;
+         ++probe) {
+        auto& entry = nearest_base_cache[(first + probe) & mask];
+        type_id expected = 0;
+
+        if (entry.type.compare_exchange_strong(
+                expected, type, std::memory_order_acq_rel)) {
+            entry.static_type.store(static_type, std::memory_order_relaxed);
+            entry.base.store(base, std::memory_order_release);
+            break;
+        }
+
+        // Entries for the same dynamic type may be for another static type,
+        // or still being filled. Keep probing; at worst, the same result is
+        // cached twice.
+    }
+
+    // If the cache is full around this slot, the result is not cached, but
+    // it is still correct.
+
+    return base;
+}
+
+template<class Policy>
+type_id vptr_nearest_base<Policy>::find_nearest_base(
+    type_id type, type_id static_type) {
+    static_assert(
+        std::is_base_of_v<std_rtti, Policy>,
+        "vptr_nearest_base requires std_rtti");
+
+#ifdef YOMM2_ITANIUM_RTTI
+    // Breadth-first search of the public bases, as described by the Itanium
+    // C++ ABI. Only runs the first time a class is seen with a given static
+    // type. Bases that do not derive from the static type - e.g. in another
+    // hierarchy - are skipped: their v-table has nothing to do with the
+    // method.
+    std::vector<const std::type_info*> queue;
+    queue.push_back(reinterpret_cast<const std::type_info*>(type));
+
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        auto ti = queue[i];
+
+        if (i > 0 && is_registered(reinterpret_cast<type_id>(ti)) &&
+            derives_from(
+                ti, reinterpret_cast<const std::type_info*>(static_type))) {
+            return reinterpret_cast<type_id>(ti);
+        }
+
+        if (auto si =
+                dynamic_cast<const abi::__si_class_type_info*>(ti)) {
+            queue.push_back(si->__base_type);
+        } else if (
+            auto vmi = dynamic_cast<const abi::__vmi_class_type_info*>(ti)) {
+            for (unsigned base = 0; base < vmi->__base_count; ++base) {
+                auto& info = vmi->__base_info[base];
+
+                if (info.__offset_flags &
+                    abi::__base_class_type_info::__public_mask) {
+                    queue.push_back(info.__base_type);
+                }
+            }
+        }
+    }
+#endif
+
+    if constexpr (has_facet<Policy, error_handler>) {
+        unknown_class_error error;
+        error.context = unknown_class_error::call;
+        error.type = type;
+        Policy::error(error);
+    }
+
+    abort();
+}
+
+#ifdef YOMM2_ITANIUM_RTTI
+template<class Policy>
+bool vptr_nearest_base<Policy>::derives_from(
+    const std::type_info* type, const std::type_info* base) {
+    if (*type == *base) {
+        return true;
+    }
+
+    if (auto si = dynamic_cast<const abi::__si_class_type_info*>(type)) {
+        return derives_from(si->__base_type, base);
+    }
+
+    if (auto vmi = dynamic_cast<const abi::__vmi_class_type_info*>(type)) {
+        for (unsigned i = 0; i < vmi->__base_count; ++i) {
+            if (derives_from(vmi->__base_info[i].__base_type, base)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+#endif
+
+template<class Policy>
+std::vector<type_id> vptr_nearest_base<Policy>::vptr_types;
+
+template<class Policy>
+typename vptr_nearest_base<Policy>::cache_entry
+    vptr_nearest_base<Policy>::nearest_base_cache[nearest_base_cache_size];
+
+}
+}
+}
+
+#endif
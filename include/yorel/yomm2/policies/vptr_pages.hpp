@@ -0,0 +1,162 @@
+
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_POLICY_VPTR_PAGES_HPP
+#define YOREL_YOMM2_POLICY_VPTR_PAGES_HPP
+
+#include <yorel/yomm2/policies/vptr_vector.hpp>
+
+#include <algorithm>
+#include <new>
+
+namespace yorel {
+namespace yomm2 {
+namespace policy {
+
+template<class Policy, class Root>
+struct yOMM2_API_gcc vptr_pages : vptr_vector<Policy> {
+    // Can be overridden in Policy. Must be a power of two.
+    static constexpr std::size_t vptr_page_size = 4096;
+
+    // The state of the pages of one class. Freed objects are recycled through
+    // the pool of the page they live in, which is that of their dynamic class,
+    // regardless of the static type of the pointer they are deleted through.
+    struct page_pool {
+        std::size_t header_size;
+        std::size_t object_size;
+        void (*destroy)(void*);
+        void* free_list;
+        char* next;
+        char* last;
+    };
+
+    // Each page starts with a header, followed by as many objects as fit in
+    // the page. The address of the static vptr must come first: it is read by
+    // 'dynamic_vptr'.
+    struct page_header {
+        std::uintptr_t** vptr;
+        page_pool* pool;
+    };
+
+    template<class Class>
+    struct class_pool {
+        static constexpr std::size_t header_size =
+            (sizeof(page_header) + alignof(Class) - 1) / alignof(Class) *
+            alignof(Class);
+        static constexpr std::size_t object_size =
+            ((std::max)(sizeof(Class), sizeof(void*)) + alignof(Class) - 1) /
+            alignof(Class) * alignof(Class);
+
+        static_assert(
+            (Policy::vptr_page_size & (Policy::vptr_page_size - 1)) == 0,
+            "page size must be a power of two");
+        static_assert(
+            header_size + object_size <= Policy::vptr_page_size,
+            "page too small for class");
+
+        static void destroy(void* p) {
+            static_cast<Class*>(p)->~Class();
+        }
+
+        static page_pool pool;
+    };
+
+    static page_header* header_of(const void* p) {
+        return reinterpret_cast<page_header*>(
+            reinterpret_cast<std::uintptr_t>(p) &
+            ~(Policy::vptr_page_size - 1));
+    }
+
+    template<class Class>
+    static void* allocate_paged() {
+        auto& pool = class_pool<Class>::pool;
+
+        if (pool.free_list) {
+            auto p = pool.free_list;
+            pool.free_list = *static_cast<void**>(p);
+
+            return p;
+        }
+
+        // No arithmetic on 'next' before the first page is allocated.
+        if (!pool.next ||
+            static_cast<std::size_t>(pool.last - pool.next) <
+                pool.object_size) {
+            auto page = static_cast<char*>(::operator new(
+                Policy::vptr_page_size,
+                std::align_val_t(Policy::vptr_page_size)));
+            auto header = reinterpret_cast<page_header*>(page);
+            header->vptr = &Policy::template static_vptr<Class>;
+            header->pool = &pool;
+            pool.next = page + pool.header_size;
+            pool.last = page + Policy::vptr_page_size;
+        }
+
+        auto p = pool.next;
+        pool.next += pool.object_size;
+
+        return p;
+    }
+
+    static void deallocate_paged(void* p) {
+        // Pages are never released, objects are recycled for the class of the
+        // page.
+        auto& pool = *header_of(p)->pool;
+        *static_cast<void**>(p) = pool.free_list;
+        pool.free_list = p;
+    }
+
+    template<class Class, typename... Args>
+    static Class* new_paged(Args&&... args) {
+        auto p = allocate_paged<Class>();
+
+        try {
+            return new (p) Class(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate_paged(p);
+            throw;
+        }
+    }
+
+    // 'obj' may point to a base subobject of an object of a derived class; the
+    // object is destroyed as an instance of its dynamic class, which need not
+    // have a virtual destructor.
+    template<class Class>
+    static void delete_paged(Class* obj) {
+        auto header = header_of(obj);
+        auto& pool = *header->pool;
+        auto page = reinterpret_cast<char*>(header);
+        auto offset = static_cast<std::size_t>(
+                          reinterpret_cast<const char*>(obj) - page) -
+            pool.header_size;
+        auto p = page + pool.header_size +
+            offset / pool.object_size * pool.object_size;
+        pool.destroy(p);
+        deallocate_paged(p);
+    }
+
+    template<class Class>
+    static const std::uintptr_t* dynamic_vptr(const Class& arg) {
+        if constexpr (std::is_base_of_v<Root, Class>) {
+            // The static vptr is updated in place by 'update'.
+            return *header_of(&arg)->vptr;
+        } else {
+            return vptr_vector<Policy>::dynamic_vptr(arg);
+        }
+    }
+};
+
+template<class Policy, class Root>
+template<class Class>
+typename vptr_pages<Policy, Root>::page_pool
+    vptr_pages<Policy, Root>::class_pool<Class>::pool = {
+        header_size, object_size, destroy, nullptr, nullptr, nullptr};
+
+}
+}
+}
+
+#endif
@@ -19,9 +19,14 @@
 #include <yorel/yomm2/policies/std_rtti.hpp>
 #include <yorel/yomm2/policies/vptr_vector.hpp>
 #include <yorel/yomm2/policies/vptr_map.hpp>
+#include <yorel/yomm2/policies/vptr_pages.hpp>
+#include <yorel/yomm2/policies/vptr_nearest_base.hpp>
 #include <yorel/yomm2/policies/basic_indirect_vptr.hpp>
+#include <yorel/yomm2/policies/basic_generation_vptr.hpp>
+#include <yorel/yomm2/policies/basic_overlay.hpp>
 #include <yorel/yomm2/policies/basic_error_output.hpp>
 #include <yorel/yomm2/policies/basic_trace_output.hpp>
+#include <yorel/yomm2/policies/basic_event_output.hpp>
 #include <yorel/yomm2/policies/fast_perfect_hash.hpp>
 #include <yorel/yomm2/policies/vectored_error.hpp>
 
@@ -113,6 +118,17 @@ extern template class __declspec(dllimport) basic_policy<
     checked_perfect_hash<debug_shared>, basic_error_output<debug_shared>,
     basic_trace_output<debug_shared>,
     backward_compatible_error_handler<debug_shared>>;
+extern template class __declspec(dllimport) basic_domain<release_shared>;
+extern template class __declspec(dllimport) vptr_vector<release_shared>;
+extern template class __declspec(dllimport) vectored_error<
+    release_shared, backward_compatible_error_handler<release_shared>>;
+extern template class __declspec(dllimport) fast_perfect_hash<release_shared>;
+extern template class __declspec(dllimport)
+backward_compatible_error_handler<release_shared>;
+extern template class __declspec(dllimport) basic_policy<
+    release_shared, std_rtti, fast_perfect_hash<release_shared>,
+    vptr_vector<release_shared>,
+    backward_compatible_error_handler<release_shared>>;
 #endif
 
 #ifndef BOOST_NO_RTTI
@@ -123,14 +139,11 @@ struct yOMM2_API_gcc debug_shared
           basic_trace_output<debug_shared>,
           backward_compatible_error_handler<debug_shared>> {};
 
-struct yOMM2_API_gcc release_shared : debug_shared {
-    template<class Class>
-    static const std::uintptr_t* dynamic_vptr(const Class& arg) {
-        auto index = dynamic_type(arg);
-        index = fast_perfect_hash<debug_shared>::hash_type_id(index);
-        return vptrs[index];
-    }
-};
+struct yOMM2_API_gcc release_shared
+    : basic_policy<
+          release_shared, std_rtti, fast_perfect_hash<release_shared>,
+          vptr_vector<release_shared>,
+          backward_compatible_error_handler<release_shared>> {};
 #endif
 
 #ifdef NDEBUG
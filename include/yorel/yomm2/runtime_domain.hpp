@@ -0,0 +1,468 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_RUNTIME_DOMAIN_HPP
+#define YOREL_YOMM2_RUNTIME_DOMAIN_HPP
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+#include <yorel/yomm2/core.hpp>
+
+namespace yorel {
+namespace yomm2 {
+
+namespace detail {
+
+// A runtime domain is compiled by the same compiler as a static domain. It
+// temporarily lends its catalogs to a private policy, derived from the
+// domain's policy, then takes ownership of the tables it produced. The vptr
+// placement and type hash facets are replaced, because the domain keeps its
+// own vptr array and hash factors.
+
+template<class Facet>
+using is_runtime_domain_replaced_facet = std::bool_constant<
+    std::is_base_of_v<policy::type_hash, Facet> ||
+    std::is_base_of_v<policy::vptr_placement, Facet> ||
+    std::is_base_of_v<policy::indirect_vptr, Facet>>;
+
+template<class Policy>
+struct runtime_domain_policy;
+
+template<class Policy>
+using runtime_domain_policy_base = boost::mp11::mp_apply<
+    policy::basic_policy,
+    boost::mp11::mp_append<
+        types<runtime_domain_policy<Policy>>,
+        boost::mp11::mp_remove_if<
+            typename Policy::template rebind<
+                runtime_domain_policy<Policy>>::facets,
+            is_runtime_domain_replaced_facet>,
+        types<
+            policy::fast_perfect_hash<runtime_domain_policy<Policy>>,
+            policy::vptr_vector<runtime_domain_policy<Policy>>>>>;
+
+template<class Policy>
+struct runtime_domain_policy : runtime_domain_policy_base<Policy> {};
+
+} // namespace detail
+
+template<class Policy = YOMM2_DEFAULT_POLICY>
+class runtime_domain {
+    using shadow_policy = detail::runtime_domain_policy<Policy>;
+    using type_index_type = decltype(Policy::type_index(0));
+
+    struct selected_method {
+        const detail::method_info* info;
+        std::size_t index;
+    };
+
+    std::vector<const detail::class_info*> selected_classes;
+    std::vector<selected_method> selected_methods;
+
+    // catalogs lent to the compiler
+    std::deque<detail::class_info> classes;
+    std::deque<std::uintptr_t*> static_vptrs;
+    std::deque<detail::method_info> methods;
+    std::deque<detail::definition_info> definitions;
+    std::vector<std::size_t> slots_strides;
+
+    // tables
+    std::vector<std::uintptr_t> dispatch_data_;
+    std::vector<const std::uintptr_t*> vptrs;
+    std::vector<type_id> control;
+    std::vector<const std::size_t*> method_slots_strides;
+    type_id hash_mult = 0;
+    std::size_t hash_shift = 0;
+
+    static std::atomic<std::size_t> method_count;
+    static thread_local const runtime_domain* current_;
+
+    template<class Method>
+    static std::size_t method_index() {
+        static const std::size_t index = method_count++;
+        return index;
+    }
+
+    void add_class(type_id type);
+    void add_class(const detail::class_info& info);
+    void unknown_class(
+        type_id type, decltype(unknown_class_error::context) context) const;
+
+    const std::uintptr_t* dynamic_vptr(type_id type) const;
+
+    template<typename ArgType>
+    const std::uintptr_t* vptr(const ArgType& arg) const;
+
+    template<class Method, typename... A, typename... Args>
+    auto resolve_aux(detail::types<A...>*, const Args&... args) const;
+
+  public:
+    class scope;
+
+    runtime_domain() = default;
+    runtime_domain(const runtime_domain&) = delete;
+    runtime_domain(runtime_domain&&) = default;
+
+    template<class... Classes>
+    runtime_domain& add_classes();
+
+    template<class... Methods>
+    runtime_domain& add_methods();
+
+    auto update();
+
+    template<class Method, typename... Args>
+    typename Method::function_pointer_type resolve(const Args&... args) const;
+
+    template<class Method, typename... Args>
+    decltype(auto) call(Args&&... args) const {
+        return resolve<Method>(args...)(std::forward<Args>(args)...);
+    }
+
+    const std::vector<std::uintptr_t>& dispatch_data() const {
+        return dispatch_data_;
+    }
+
+    static const runtime_domain* current() {
+        return current_;
+    }
+};
+
+template<class Policy>
+std::atomic<std::size_t> runtime_domain<Policy>::method_count;
+
+template<class Policy>
+thread_local const runtime_domain<Policy>* runtime_domain<Policy>::current_;
+
+template<class Policy>
+class runtime_domain<Policy>::scope {
+    const runtime_domain* previous;
+
+  public:
+    explicit scope(const runtime_domain& domain) : previous(current_) {
+        current_ = &domain;
+    }
+
+    scope(const scope&) = delete;
+
+    ~scope() {
+        current_ = previous;
+    }
+};
+
+template<class Policy>
+template<class... Classes>
+runtime_domain<Policy>& runtime_domain<Policy>::add_classes() {
+    (add_class(Policy::template static_type<Classes>()), ...);
+
+    return *this;
+}
+
+template<class Policy>
+template<class... Methods>
+runtime_domain<Policy>& runtime_domain<Policy>::add_methods() {
+    static_assert(
+        (std::is_same_v<typename Methods::policy_type, Policy> && ...),
+        "methods must belong to the domain's policy");
+
+    (
+        [this](const detail::method_info& info, std::size_t index) {
+            for (auto iter = info.vp_begin; iter != info.vp_end; ++iter) {
+                add_class(*iter);
+            }
+
+            for (auto& selected : selected_methods) {
+                if (selected.info == &info) {
+                    return;
+                }
+            }
+
+            selected_methods.push_back({&info, index});
+        }(Methods::fn, method_index<Methods>()),
+        ...);
+
+    return *this;
+}
+
+template<class Policy>
+void runtime_domain<Policy>::add_class(type_id type) {
+    auto found = false;
+
+    for (auto& info : Policy::classes) {
+        if (Policy::type_index(info.type) == Policy::type_index(type)) {
+            add_class(info);
+            found = true;
+        }
+    }
+
+    if (!found) {
+        unknown_class(type, unknown_class_error::update);
+    }
+}
+
+template<class Policy>
+void runtime_domain<Policy>::add_class(const detail::class_info& info) {
+    if (std::find(selected_classes.begin(), selected_classes.end(), &info) !=
+        selected_classes.end()) {
+        return;
+    }
+
+    selected_classes.push_back(&info);
+
+    for (auto iter = info.first_base; iter != info.last_base; ++iter) {
+        add_class(*iter);
+    }
+}
+
+template<class Policy>
+void runtime_domain<Policy>::unknown_class(
+    type_id type, decltype(unknown_class_error::context) context) const {
+    unknown_class_error error;
+    error.context = context;
+    error.type = type;
+
+    if constexpr (Policy::template has_facet<policy::error_handler>) {
+        Policy::error(error_type(error));
+    }
+
+    abort();
+}
+
+template<class Policy>
+auto runtime_domain<Policy>::update() {
+    using namespace detail;
+
+    // The shadow policy's catalogs and tables are shared by all the domains
+    // of the same policy.
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if constexpr (Policy::template has_facet<policy::trace_output>) {
+        shadow_policy::trace_enabled = Policy::trace_enabled;
+    }
+
+    classes.clear();
+    static_vptrs.clear();
+    methods.clear();
+    definitions.clear();
+
+    std::unordered_set<type_index_type> known_classes;
+
+    for (auto original : selected_classes) {
+        auto& info = classes.emplace_back();
+        info.type = original->type;
+        info.static_vptr = &static_vptrs.emplace_back();
+        info.first_base = original->first_base;
+        info.last_base = original->last_base;
+        info.is_abstract = original->is_abstract;
+        shadow_policy::classes.push_back(info);
+        known_classes.insert(Policy::type_index(info.type));
+    }
+
+    std::size_t slots_strides_size = 0;
+
+    for (auto& selected : selected_methods) {
+        slots_strides_size += 2 * selected.info->arity() - 1;
+    }
+
+    slots_strides.assign(slots_strides_size, 0);
+    auto slots_strides_iter = slots_strides.data();
+
+    for (auto& selected : selected_methods) {
+        auto& original = *selected.info;
+        auto& info = methods.emplace_back();
+        info.name = original.name;
+        info.vp_begin = original.vp_begin;
+        info.vp_end = original.vp_end;
+        info.ambiguous = original.ambiguous;
+        info.not_implemented = original.not_implemented;
+        info.method_type = original.method_type;
+        info.slots_strides_ptr = slots_strides_iter;
+        slots_strides_iter += 2 * original.arity() - 1;
+
+        if (!original.specs.empty()) {
+            for (auto& original_definition : original.specs) {
+                // Overlays are not supported.
+                if (original_definition.overlay) {
+                    continue;
+                }
+
+                // Definitions that specialize on classes that are not part
+                // of the domain cannot be selected.
+                if (!std::all_of(
+                        original_definition.vp_begin,
+                        original_definition.vp_end, [&](type_id type) {
+                            return known_classes.find(Policy::type_index(
+                                       type)) != known_classes.end();
+                        })) {
+                    continue;
+                }
+
+                // 'next' pointers are shared with the static domain; they
+                // are not updated.
+                auto& definition = definitions.emplace_back();
+                definition.type = original_definition.type;
+                definition.vp_begin = original_definition.vp_begin;
+                definition.vp_end = original_definition.vp_end;
+                definition.pf = original_definition.pf;
+                info.specs.push_back(definition);
+            }
+        }
+
+        shadow_policy::methods.push_back(info);
+    }
+
+    compiler<shadow_policy> comp;
+    comp.update();
+
+    for (auto& info : classes) {
+        shadow_policy::classes.remove(info);
+    }
+
+    for (auto& info : methods) {
+        shadow_policy::methods.remove(info);
+    }
+
+    dispatch_data_.swap(shadow_policy::dispatch_data);
+    shadow_policy::dispatch_data.clear();
+    vptrs.swap(shadow_policy::vptrs);
+    shadow_policy::vptrs.clear();
+    hash_mult = shadow_policy::hash_mult;
+    hash_shift = shadow_policy::hash_shift;
+
+    if constexpr (Policy::template has_facet<policy::runtime_checks>) {
+        control.assign(vptrs.size(), 0);
+
+        for (auto& info : classes) {
+            control[shadow_policy::hash_type_id(info.type)] = info.type;
+        }
+    }
+
+    method_slots_strides.clear();
+    auto info_iter = methods.begin();
+
+    for (auto& selected : selected_methods) {
+        if (method_slots_strides.size() <= selected.index) {
+            method_slots_strides.resize(selected.index + 1);
+        }
+
+        method_slots_strides[selected.index] =
+            (info_iter++)->slots_strides_ptr;
+    }
+
+    return comp.report;
+}
+
+template<class Policy>
+inline const std::uintptr_t*
+runtime_domain<Policy>::dynamic_vptr(type_id type) const {
+    auto index = (hash_mult * type) >> hash_shift;
+
+    if constexpr (Policy::template has_facet<policy::runtime_checks>) {
+        if (index >= control.size() || control[index] != type) {
+            unknown_class(type, unknown_class_error::call);
+        }
+    }
+
+    return vptrs[index];
+}
+
+template<class Policy>
+template<typename ArgType>
+inline const std::uintptr_t*
+runtime_domain<Policy>::vptr(const ArgType& arg) const {
+    static_assert(
+        !detail::is_enum_tag<ArgType>,
+        "enum_tag arguments cannot be dispatched in a runtime_domain");
+
+    if constexpr (detail::is_virtual_ptr<ArgType>) {
+        // The vptr cached in the virtual_ptr belongs to the static domain.
+        return vptr(*arg);
+    } else {
+        return dynamic_vptr(Policy::dynamic_type(arg));
+    }
+}
+
+template<class Policy>
+template<class Method, typename... Args>
+inline typename Method::function_pointer_type
+runtime_domain<Policy>::resolve(const Args&... args) const {
+    return resolve_aux<Method>(
+        static_cast<typename Method::declared_argument_types*>(nullptr),
+        args...);
+}
+
+template<class Policy>
+template<class Method, typename... A, typename... Args>
+inline auto runtime_domain<Policy>::resolve_aux(
+    detail::types<A...>*, const Args&... args) const {
+    using namespace detail;
+
+    static_assert(
+        sizeof...(A) == sizeof...(Args), "wrong number of arguments");
+
+    auto index = method_index<Method>();
+    BOOST_ASSERT_MSG(
+        index < method_slots_strides.size() && method_slots_strides[index],
+        "method not added to runtime_domain");
+    auto slots_strides = method_slots_strides[index];
+
+    // Same algorithm as method::resolve_uni and method::resolve_multi_*,
+    // using the domain's slots, strides and vptrs.
+    std::uintptr_t pf = 0;
+    const std::uintptr_t* dispatch = nullptr;
+    std::size_t vp = 0;
+
+    auto resolve_arg = [&](const std::uintptr_t* vtbl) {
+        if (vp == 0) {
+            if constexpr (Method::arity == 1) {
+                pf = vtbl[slots_strides[0]];
+            } else {
+                dispatch =
+                    reinterpret_cast<const std::uintptr_t*>(
+                        vtbl[slots_strides[0]]);
+            }
+        } else {
+            dispatch = dispatch +
+                vtbl[slots_strides[vp]] *
+                    slots_strides[Method::arity + vp - 1];
+        }
+
+        ++vp;
+    };
+
+    (
+        [&](const auto& arg) {
+            if constexpr (is_virtual<A>::value) {
+                resolve_arg(vptr(argument_traits<Policy, A>::rarg(arg)));
+            }
+        }(args),
+        ...);
+
+    if constexpr (Method::arity > 1) {
+        pf = *dispatch;
+    }
+
+    return reinterpret_cast<typename Method::function_pointer_type>(pf);
+}
+
+template<class Method, typename... Args>
+decltype(auto) call_in_domain(Args&&... args) {
+    using domain_type = runtime_domain<typename Method::policy_type>;
+
+    if (auto domain = domain_type::current()) {
+        return domain->template call<Method>(std::forward<Args>(args)...);
+    }
+
+    return Method::fn(std::forward<Args>(args)...);
+}
+
+} // namespace yomm2
+} // namespace yorel
+
+#endif
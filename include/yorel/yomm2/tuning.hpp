@@ -0,0 +1,195 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef YOREL_YOMM2_TUNING_HPP
+#define YOREL_YOMM2_TUNING_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <yorel/yomm2/core.hpp>
+
+namespace yorel {
+namespace yomm2 {
+namespace tuning {
+
+// -----------------------------------------------------------------------------
+// candidate policies
+
+// Each candidate is a class template, instantiated with a key specific to the
+// workload, so each workload gets its own registry of classes and methods.
+
+template<class Key>
+struct vector_policy : policy::release::rebind<vector_policy<Key>> {
+    static constexpr const char* candidate = "vector_policy";
+
+    static void definition(std::ostream& os, const std::string& name) {
+        os << "struct " << name << "\n"
+           << "    : yorel::yomm2::policy::release::rebind<" << name
+           << "> {};\n";
+    }
+};
+
+template<class Key>
+struct map_policy
+    : policy::release::rebind<map_policy<Key>>::template remove<
+          policy::type_hash>::
+          template replace<
+              policy::external_vptr, policy::vptr_map<map_policy<Key>>> {
+    static constexpr const char* candidate = "map_policy";
+
+    static void definition(std::ostream& os, const std::string& name) {
+        os << "struct " << name << "\n"
+           << "    : yorel::yomm2::policy::release::rebind<" << name
+           << ">::remove<\n"
+           << "          yorel::yomm2::policy::type_hash>::replace<\n"
+           << "          yorel::yomm2::policy::external_vptr,\n"
+           << "          yorel::yomm2::policy::vptr_map<" << name
+           << ">> {};\n";
+    }
+};
+
+template<class Key>
+struct indirect_policy : policy::release::rebind<indirect_policy<Key>>,
+                         policy::basic_indirect_vptr<indirect_policy<Key>> {
+    static constexpr const char* candidate = "indirect_policy";
+
+    static void definition(std::ostream& os, const std::string& name) {
+        os << "struct " << name << "\n"
+           << "    : yorel::yomm2::policy::release::rebind<" << name
+           << ">,\n"
+           << "      yorel::yomm2::policy::basic_indirect_vptr<" << name
+           << "> {};\n";
+    }
+};
+
+template<class Key>
+struct packed_slots_policy
+    : policy::release::rebind<packed_slots_policy<Key>>,
+      policy::packed_slots {
+    static constexpr const char* candidate = "packed_slots_policy";
+
+    static void definition(std::ostream& os, const std::string& name) {
+        os << "struct " << name << "\n"
+           << "    : yorel::yomm2::policy::release::rebind<" << name
+           << ">,\n"
+           << "      yorel::yomm2::policy::packed_slots {};\n";
+    }
+};
+
+template<template<class> class... Candidates>
+struct candidates {};
+
+using default_candidates = candidates<
+    vector_policy, map_policy, indirect_policy, packed_slots_policy>;
+
+// -----------------------------------------------------------------------------
+// measurements
+
+struct result {
+    std::string candidate;
+    double update_ms;
+    double ns_per_call;
+    std::function<void(std::ostream&, const std::string&)> definition;
+};
+
+} // namespace tuning
+
+namespace detail {
+
+template<template<class> class Workload>
+struct tuning_key {};
+
+template<template<class> class Workload, template<class> class Candidate>
+tuning::result tuning_measure(std::size_t repetitions) {
+    using policy_type = Candidate<tuning_key<Workload>>;
+    using clock = std::chrono::steady_clock;
+
+    auto start = clock::now();
+    update<policy_type>();
+    std::chrono::duration<double, std::milli> update_time =
+        clock::now() - start;
+
+    // Construct the workload after update(), as it may contain virtual_ptrs.
+    Workload<policy_type> workload;
+    workload(); // warm up the caches
+
+    auto best = (std::numeric_limits<double>::max)();
+
+    for (std::size_t i = 0; i < repetitions; ++i) {
+        auto start = clock::now();
+        std::size_t calls = workload();
+        std::chrono::duration<double, std::nano> time = clock::now() - start;
+
+        if (calls) {
+            best = (std::min)(best, time.count() / calls);
+        }
+    }
+
+    return tuning::result{
+        policy_type::candidate, update_time.count(), best,
+        &policy_type::definition};
+}
+
+template<template<class> class Workload, template<class> class... Candidates>
+std::vector<tuning::result>
+tuning_run(tuning::candidates<Candidates...>, std::size_t repetitions) {
+    std::vector<tuning::result> results{
+        tuning_measure<Workload, Candidates>(repetitions)...};
+
+    std::stable_sort(
+        results.begin(), results.end(), [](const auto& a, const auto& b) {
+            return a.ns_per_call < b.ns_per_call;
+        });
+
+    return results;
+}
+
+} // namespace detail
+
+namespace tuning {
+
+// Run 'Workload<Policy>' for each candidate policy. 'Workload' is a class
+// template that registers the user's classes and methods in 'Policy'. Its
+// function call operator replays a sample of the program's calls, and returns
+// the number of method calls it made. The results are sorted by time per call,
+// fastest first. A candidate is a class template taking a key, deriving from
+// 'basic_policy', with a 'candidate' name and a 'definition' function that
+// prints its definition, like the candidates above.
+template<
+    template<class> class Workload, class Candidates = default_candidates>
+std::vector<result> tune(std::size_t repetitions = 10) {
+    return yomm2::detail::tuning_run<Workload>(Candidates(), repetitions);
+}
+
+inline void print(
+    std::ostream& os, const std::vector<result>& results,
+    const std::string& policy_name = "tuned_policy") {
+    char line[128];
+
+    for (auto& r : results) {
+        std::snprintf(
+            line, sizeof(line), "%-24s %10.3f ms update %10.3f ns/call\n",
+            r.candidate.c_str(), r.update_ms, r.ns_per_call);
+        os << line;
+    }
+
+    if (!results.empty()) {
+        os << "\nrecommended:\n\n";
+        results.front().definition(os, policy_name);
+    }
+}
+
+} // namespace tuning
+} // namespace yomm2
+} // namespace yorel
+
+#endif
@@ -7,9 +7,11 @@
 #error "This should be compiled only for a shared library build."
 #endif
 
+// Building the library itself: export, don't import.
+#define yOMM2_DLL
+
 #if defined(_MSC_VER)
 #define yOMM2_API_msc __declspec(dllexport)
-#define yOMM2_DLL
 #else
 #define yOMM2_API_gcc __attribute__((__visibility__("default")))
 #endif
@@ -38,27 +40,49 @@ template class yOMM2_API_msc basic_policy<
     basic_error_output<debug_shared>, basic_trace_output<debug_shared>,
     backward_compatible_error_handler<debug_shared>>;
 
+template class yOMM2_API_msc basic_domain<release_shared>;
+template class yOMM2_API_msc vptr_vector<release_shared>;
+template class yOMM2_API_msc basic_indirect_vptr<release_shared>;
+template class yOMM2_API_msc vectored_error<
+    release_shared, backward_compatible_error_handler<release_shared>>;
+template class yOMM2_API_msc backward_compatible_error_handler<release_shared>;
+template class yOMM2_API_msc fast_perfect_hash<release_shared>;
+template class yOMM2_API_msc basic_policy<
+    release_shared, std_rtti, fast_perfect_hash<release_shared>,
+    vptr_vector<release_shared>,
+    backward_compatible_error_handler<release_shared>>;
+
 } // namespace policy
 
 template auto yOMM2_API_gcc yOMM2_API_msc update<policy::debug_shared>()
     -> detail::compiler<policy::debug_shared>;
 
+template auto yOMM2_API_gcc yOMM2_API_msc update<policy::release_shared>()
+    -> detail::compiler<policy::release_shared>;
+
+// Kept for binary compatibility with clients built against previous versions,
+// which called a non-template 'update()'.
 yOMM2_API_gcc yOMM2_API_msc auto
 update() -> detail::compiler<policy::debug_shared> {
     return update<policy::debug_shared>();
 }
 
+// The library may be compiled in a different mode than its clients, so set the
+// handlers for both shared policies.
+
 yOMM2_API_gcc yOMM2_API_msc error_handler_type
 set_error_handler(error_handler_type handler) {
     auto prev = default_policy::error;
-    default_policy::error = handler;
+    policy::debug_shared::error = handler;
+    policy::release_shared::error = handler;
     return prev;
 }
 
 yOMM2_API_gcc yOMM2_API_msc method_call_error_handler
 set_method_call_error_handler(method_call_error_handler handler) {
     auto prev = default_policy::call_error;
-    default_policy::call_error = handler;
+    policy::debug_shared::call_error = handler;
+    policy::release_shared::call_error = handler;
     return prev;
 }
 
@@ -0,0 +1,161 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Cost of creating and converting virtual_ptrs, as opposed to calling methods
+// through them (see benchmarks.cpp).
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <yorel/yomm2/keywords.hpp>
+
+using namespace yorel::yomm2;
+using namespace yorel::yomm2::policy;
+
+struct vector_policy : release::rebind<vector_policy> {};
+
+struct map_policy
+    : release::rebind<map_policy>::remove<type_hash>::replace<
+          external_vptr, vptr_map<map_policy>> {};
+
+struct indirect_policy : release::rebind<indirect_policy>,
+                         basic_indirect_vptr<indirect_policy> {};
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+
+// Downcasts from a virtual base require a dynamic_cast.
+struct Creature {
+    virtual ~Creature() {
+    }
+};
+
+struct Cat : virtual Creature {};
+
+use_classes<Animal, Dog, Creature, Cat, vector_policy> YOMM2_GENSYM;
+use_classes<Animal, Dog, Creature, Cat, map_policy> YOMM2_GENSYM;
+use_classes<Animal, Dog, Creature, Cat, indirect_policy> YOMM2_GENSYM;
+
+template<class Policy>
+void construct_matching(benchmark::State& state) {
+    Dog dog;
+    Dog* p = &dog;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(p);
+        virtual_ptr<Dog, Policy> vp(*p);
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+template<class Policy>
+void construct_non_matching(benchmark::State& state) {
+    Dog dog;
+    Animal* p = &dog;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(p);
+        virtual_ptr<Animal, Policy> vp(*p);
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+template<class Policy>
+void final(benchmark::State& state) {
+    Dog dog;
+    Dog* p = &dog;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(p);
+        auto vp = virtual_ptr<Dog, Policy>::final(*p);
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+template<class Policy>
+void cast_up(benchmark::State& state) {
+    Dog dog;
+    auto dog_vp = virtual_ptr<Dog, Policy>::final(dog);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dog_vp);
+        virtual_ptr<Animal, Policy> vp(dog_vp);
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+template<class Policy>
+void cast_down(benchmark::State& state) {
+    Dog dog;
+    virtual_ptr<Animal, Policy> animal_vp(static_cast<Animal&>(dog));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(animal_vp);
+        auto vp = animal_vp.template cast<virtual_ptr<Dog, Policy>>();
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+template<class Policy>
+void cast_down_from_virtual_base(benchmark::State& state) {
+    Cat cat;
+    virtual_ptr<Creature, Policy> creature_vp(static_cast<Creature&>(cat));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(creature_vp);
+        auto vp = creature_vp.template cast<virtual_ptr<Cat, Policy>>();
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+template<class Policy>
+void copy_shared(benchmark::State& state) {
+    auto dog_vp = make_virtual_shared<Dog, Policy>();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dog_vp);
+        virtual_shared_ptr<Dog, Policy> vp(dog_vp);
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+template<class Policy>
+void make_shared(benchmark::State& state) {
+    for (auto _ : state) {
+        auto vp = make_virtual_shared<Dog, Policy>();
+        benchmark::DoNotOptimize(vp);
+    }
+}
+
+#define VIRTUAL_PTR_BENCHMARKS(POLICY)                                         \
+    BENCHMARK_TEMPLATE(construct_matching, POLICY);                            \
+    BENCHMARK_TEMPLATE(construct_non_matching, POLICY);                        \
+    BENCHMARK_TEMPLATE(final, POLICY);                                         \
+    BENCHMARK_TEMPLATE(cast_up, POLICY);                                       \
+    BENCHMARK_TEMPLATE(cast_down, POLICY);                                     \
+    BENCHMARK_TEMPLATE(cast_down_from_virtual_base, POLICY);                   \
+    BENCHMARK_TEMPLATE(copy_shared, POLICY);                                   \
+    BENCHMARK_TEMPLATE(make_shared, POLICY)
+
+VIRTUAL_PTR_BENCHMARKS(vector_policy);
+VIRTUAL_PTR_BENCHMARKS(map_policy);
+VIRTUAL_PTR_BENCHMARKS(indirect_policy);
+
+int main(int argc, char** argv) {
+    update<vector_policy>();
+    update<map_policy>();
+    update<indirect_policy>();
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Domain shared by test_churn and the plugins it loads and unloads.
+
+#ifndef CHURN_DEFINED
+#define CHURN_DEFINED
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+struct churn_policy
+    : yorel::yomm2::policy::release::rebind<churn_policy> {};
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+
+// Each plugin adds an instance of this template.
+template<int N>
+struct Plugin : Dog {};
+
+struct describe_;
+using describe = yorel::yomm2::method<
+    describe_, std::string(yorel::yomm2::virtual_<const Animal&>),
+    churn_policy>;
+
+struct meet_;
+using meet = yorel::yomm2::method<
+    meet_,
+    std::string(
+        yorel::yomm2::virtual_<const Animal&>,
+        yorel::yomm2::virtual_<const Animal&>),
+    churn_policy>;
+
+#endif
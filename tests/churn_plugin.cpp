@@ -0,0 +1,36 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Built several times, with different values of CHURN_PLUGIN.
+
+#include <string>
+
+#include "churn.hpp"
+
+using namespace yorel::yomm2;
+
+using plugin_class = Plugin<CHURN_PLUGIN>;
+
+use_classes<Dog, plugin_class, churn_policy> YOMM2_GENSYM;
+
+std::string describe_plugin(const plugin_class&) {
+    return "plugin " + std::to_string(CHURN_PLUGIN);
+}
+
+describe::add_function<describe_plugin> YOMM2_GENSYM;
+
+std::string meet_dog(const plugin_class&, const Dog&) {
+    return "plugin " + std::to_string(CHURN_PLUGIN) + " meets dog";
+}
+
+std::string meet_plugin(const Animal&, const plugin_class&) {
+    return "meets plugin " + std::to_string(CHURN_PLUGIN);
+}
+
+meet::add_functions<meet_dog, meet_plugin> YOMM2_GENSYM;
+
+extern "C" Animal* make_animal() {
+    return new plugin_class;
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <any>
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::any;
+using std::string;
+
+struct ping {
+    int id;
+};
+
+struct payload {
+    static int copies;
+
+    payload() = default;
+
+    payload(const payload&) {
+        ++copies;
+    }
+
+    int value = 0;
+};
+
+int payload::copies;
+
+namespace uni_method {
+
+using test_policy = test_policy_<__COUNTER__>;
+
+use_classes<any, ping, payload, string, int, double, test_policy> YOMM2_GENSYM;
+
+using handle = method<void, string(virtual_<const any&>), test_policy>;
+
+string handle_any(const any&) {
+    return "unknown";
+}
+
+string handle_ping(const ping& p) {
+    return "ping " + std::to_string(p.id);
+}
+
+string handle_string(const string& s) {
+    return s;
+}
+
+string handle_int(const int& i) {
+    return std::to_string(i);
+}
+
+const payload* handled_payload;
+
+string handle_payload(const payload& p) {
+    handled_payload = &p;
+    return "payload";
+}
+
+handle::add_functions<
+    handle_any, handle_ping, handle_string, handle_int, handle_payload>
+    YOMM2_GENSYM;
+
+using bump = method<void, void(virtual_<any&>), test_policy>;
+
+void bump_payload(payload& p) {
+    ++p.value;
+}
+
+void bump_int(int& i) {
+    ++i;
+}
+
+bump::add_functions<bump_payload, bump_int> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_any_uni_method) {
+    update<test_policy>();
+
+    BOOST_TEST(handle::fn(any(ping{42})) == "ping 42");
+    BOOST_TEST(handle::fn(any(string("hello"))) == "hello");
+    BOOST_TEST(handle::fn(any(7)) == "7");
+    // registered, no specific definition
+    BOOST_TEST(handle::fn(any(3.14)) == "unknown");
+
+    any a = payload();
+    payload::copies = 0;
+    BOOST_TEST(handle::fn(a) == "payload");
+    BOOST_TEST(payload::copies == 0);
+    BOOST_TEST(handled_payload == std::any_cast<payload>(&a));
+
+    bump::fn(a);
+    bump::fn(a);
+    BOOST_TEST(std::any_cast<payload&>(a).value == 2);
+
+    any i = 1;
+    bump::fn(i);
+    BOOST_TEST(std::any_cast<int>(i) == 2);
+}
+
+} // namespace uni_method
+
+namespace multi_method {
+
+using test_policy = test_policy_<__COUNTER__>;
+
+use_classes<any, string, int, test_policy> YOMM2_GENSYM;
+
+using combine = method<
+    void, string(virtual_<const any&>, virtual_<const any&>), test_policy>;
+
+string combine_any(const any&, const any&) {
+    return "?";
+}
+
+string combine_ints(const int& a, const int& b) {
+    return std::to_string(a + b);
+}
+
+string combine_string_int(const string& s, const int& n) {
+    string result;
+
+    for (int i = 0; i < n; ++i) {
+        result += s;
+    }
+
+    return result;
+}
+
+combine::add_functions<combine_any, combine_ints, combine_string_int>
+    YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_any_multi_method) {
+    update<test_policy>();
+
+    BOOST_TEST(combine::fn(any(2), any(3)) == "5");
+    BOOST_TEST(combine::fn(any(string("ab")), any(3)) == "ababab");
+    BOOST_TEST(combine::fn(any(3), any(string("ab"))) == "?");
+}
+
+} // namespace multi_method
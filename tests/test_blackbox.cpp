@@ -422,6 +422,10 @@ BOOST_AUTO_TEST_CASE(update_report) {
     // 'meet' dispatch table is one cell, containing 'not_implemented'
     BOOST_TEST(report.cells == 1);
     BOOST_TEST(report.concrete_cells == 1);
+    // the compiler's data structures are allocated from its arena
+    BOOST_TEST(report.allocations != 0);
+    BOOST_TEST(report.allocated_bytes != 0);
+    auto allocations = report.allocations;
 
     YOMM2_STATIC(kick::add_function<fn<Animal>>);
     report = update<test_policy>().report;
@@ -459,6 +463,7 @@ BOOST_AUTO_TEST_CASE(update_report) {
     BOOST_TEST(report.concrete_cells == 4);
     BOOST_TEST(report.ambiguous == 0);
     BOOST_TEST(report.concrete_ambiguous == 0);
+    BOOST_TEST(report.allocations > allocations);
 }
 
 } // namespace report
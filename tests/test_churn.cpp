@@ -0,0 +1,212 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Load and unload plugins that add classes and definitions, calling 'update'
+// after each change, and check that neither the dispatch data nor the heap
+// grow over time. Also a benchmark for 'update'.
+//
+// usage: test_churn [cycles [plugins]]
+//
+// Each cycle loads and unloads each plugin. Statistics are printed every
+// cycles/10 cycles.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define CHURN_HEAP_STATS
+#endif
+
+#include "churn.hpp"
+
+using namespace yorel::yomm2;
+using std::cout;
+using std::setw;
+using std::string;
+
+std::string describe_animal(const Animal&) {
+    return "animal";
+}
+
+std::string describe_dog(const Dog&) {
+    return "dog";
+}
+
+describe::add_functions<describe_animal, describe_dog> YOMM2_GENSYM;
+
+std::string meet_animals(const Animal&, const Animal&) {
+    return "ignore";
+}
+
+meet::add_functions<meet_animals> YOMM2_GENSYM;
+
+use_classes<Animal, Dog, churn_policy> YOMM2_GENSYM;
+
+struct heap_stats {
+    std::size_t in_use = 0, free = 0;
+
+    static heap_stats get() {
+        heap_stats stats;
+#ifdef CHURN_HEAP_STATS
+        auto info = mallinfo2();
+        stats.in_use = info.uordblks + info.hblkhd;
+        stats.free = info.fordblks;
+#endif
+        return stats;
+    }
+};
+
+struct counts {
+    std::size_t classes, describe_specs, meet_specs;
+
+    static counts get() {
+        return {
+            std::size_t(std::distance(
+                churn_policy::classes.begin(), churn_policy::classes.end())),
+            std::size_t(std::distance(
+                describe::fn.specs.begin(), describe::fn.specs.end())),
+            std::size_t(std::distance(
+                meet::fn.specs.begin(), meet::fn.specs.end()))};
+    }
+
+    bool operator==(const counts& other) const {
+        return classes == other.classes &&
+            describe_specs == other.describe_specs &&
+            meet_specs == other.meet_specs;
+    }
+};
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        cout << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+using clock_type = std::chrono::steady_clock;
+
+int main(int argc, char* argv[]) {
+    int cycles = argc > 1 ? std::atoi(argv[1]) : 100;
+    int plugins = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    char dir[4096];
+    dir[readlink("/proc/self/exe", dir, sizeof(dir))] = 0;
+    *strrchr(dir, '/') = 0;
+
+    update<churn_policy>();
+    auto baseline = counts::get();
+
+    Dog dog;
+    check(describe::fn(dog) == "dog", "describe dog before loading plugins");
+
+    clock_type::duration update_time{}, worst_update{};
+    std::size_t updates = 0;
+    auto timed_update = [&]() {
+        auto before = clock_type::now();
+        update<churn_policy>();
+        auto elapsed = clock_type::now() - before;
+        update_time += elapsed;
+        worst_update = std::max(worst_update, elapsed);
+        ++updates;
+    };
+
+    // Allocations made by the first cycles - e.g. growing the dispatch data
+    // to its peak size - are not leaks.
+    const int warm_up = std::min(cycles, 2);
+    std::size_t capacity_after_warm_up = 0;
+    heap_stats heap_after_warm_up;
+
+    cout << setw(8) << "cycle" << setw(12) << "update us" << setw(12)
+         << "worst us" << setw(12) << "dd size" << setw(12) << "dd capacity"
+         << setw(12) << "heap used" << setw(12) << "heap free" << "\n";
+
+    auto report_every = std::max(cycles / 10, 1);
+
+    for (int cycle = 1; cycle <= cycles; ++cycle) {
+        for (int plugin = 1; plugin <= plugins; ++plugin) {
+            auto path = string(dir) + "/libchurn_plugin_" +
+                std::to_string(plugin) + ".so";
+            auto handle = dlopen(path.c_str(), RTLD_NOW);
+
+            if (!handle) {
+                cout << "dlopen() failed: " << dlerror() << "\n";
+                return 1;
+            }
+
+            timed_update();
+
+            auto make_animal = reinterpret_cast<Animal* (*)()>(
+                dlsym(handle, "make_animal"));
+
+            if (!make_animal) {
+                cout << "dlsym() failed: " << dlerror() << "\n";
+                return 1;
+            }
+
+            {
+                auto name = "plugin " + std::to_string(plugin);
+                std::unique_ptr<Animal> animal(make_animal());
+                check(describe::fn(*animal) == name, "describe plugin");
+                check(
+                    meet::fn(*animal, dog) == name + " meets dog",
+                    "plugin meets dog");
+                check(
+                    meet::fn(dog, *animal) == "meets " + name,
+                    "dog meets plugin");
+                check(meet::fn(dog, dog) == "ignore", "dog meets dog");
+            }
+
+            dlclose(handle);
+            timed_update();
+
+            check(counts::get() == baseline, "registrations removed");
+            check(describe::fn(dog) == "dog", "describe dog after unloading");
+        }
+
+        if (cycle == warm_up) {
+            capacity_after_warm_up = churn_policy::dispatch_data.capacity();
+            heap_after_warm_up = heap_stats::get();
+        }
+
+        if (cycle % report_every == 0 || cycle == cycles) {
+            using us = std::chrono::duration<double, std::micro>;
+            auto heap = heap_stats::get();
+            cout << setw(8) << cycle << setw(12) << std::fixed
+                 << std::setprecision(1) << us(update_time).count() / updates
+                 << setw(12) << us(worst_update).count() << setw(12)
+                 << churn_policy::dispatch_data.size() << setw(12)
+                 << churn_policy::dispatch_data.capacity() << setw(12)
+                 << heap.in_use << setw(12) << heap.free << "\n";
+            update_time = worst_update = {};
+            updates = 0;
+        }
+    }
+
+    check(
+        churn_policy::dispatch_data.capacity() == capacity_after_warm_up,
+        "dispatch data capacity is stable");
+
+#ifdef CHURN_HEAP_STATS
+    // Allow for some noise, e.g. from the dynamic loader and iostreams.
+    auto heap = heap_stats::get();
+    check(
+        heap.in_use <= heap_after_warm_up.in_use + 64 * 1024,
+        "heap usage is stable");
+#endif
+
+    return failures == 0 ? 0 : 1;
+}
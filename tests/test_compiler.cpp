@@ -47,7 +47,12 @@ auto sstr(Ts... args) {
 }
 
 template<typename T>
-auto sstr(const std::unordered_set<T>& container) {
+auto sstr(const std::pmr::vector<T>& container) {
+    return sstr(std::vector<T>(container.begin(), container.end()));
+}
+
+template<typename T>
+auto sstr(const std::pmr::unordered_set<T>& container) {
     return sstr(std::vector<T>(container.begin(), container.end()));
 }
 
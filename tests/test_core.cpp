@@ -8,6 +8,8 @@
 
 #include <yorel/yomm2.hpp>
 
+#include "test_util.hpp"
+
 #define BOOST_TEST_MODULE core
 #include <boost/test/included/unit_test.hpp>
 
@@ -214,6 +216,103 @@ BOOST_AUTO_TEST_CASE(casts) {
     BOOST_TEST(base_address == &dog);
 }
 
+struct Pet {
+    virtual ~Pet() {}
+};
+
+struct Cat : Pet {};
+
+struct Named {
+    virtual ~Named() {}
+    const char* name = "Felix";
+};
+
+struct NamedCat : Pet, Named {};
+
+const void* pet_this(const Pet& obj) {
+    return &obj;
+}
+
+const void* cat_this(const Cat& obj) {
+    return &obj;
+}
+
+const void* named_this(const Named& obj) {
+    return &obj;
+}
+
+const void* cat_that(Cat* obj) {
+    return obj;
+}
+
+const Cat* cat_self(const Cat& obj) {
+    return &obj;
+}
+
+BOOST_AUTO_TEST_CASE(thunk_addresses) {
+    using signature = const void*(virtual_<const Pet&>);
+
+    // same function type: install the definition itself
+    using pet_thunk =
+        thunk<default_policy, signature, pet_this, types<const Pet&>>;
+    BOOST_TEST(pet_thunk::address() == (void*)pet_this);
+
+    // a cast would not move the pointer, but the function types differ
+    using cat_thunk =
+        thunk<default_policy, signature, cat_this, types<const Cat&>>;
+    BOOST_TEST(cat_thunk::address() == (void*)cat_thunk::fn);
+
+    using cat_pointer_thunk = thunk<
+        default_policy, const void*(virtual_<Pet*>), cat_that, types<Cat*>>;
+    BOOST_TEST(cat_pointer_thunk::address() == (void*)cat_pointer_thunk::fn);
+
+    // the cast moves the pointer
+    using named_thunk = thunk<
+        default_policy, const void*(virtual_<const NamedCat&>), named_this,
+        types<const Named&>>;
+    BOOST_TEST(named_thunk::address() == (void*)named_thunk::fn);
+
+    // dynamic cast
+    using dog_thunk = thunk<
+        default_policy, const void*(virtual_<const Animal&>), dog_this,
+        types<const Dog&>>;
+    BOOST_TEST(dog_thunk::address() == (void*)dog_thunk::fn);
+
+    // different return type
+    using cat_self_thunk =
+        thunk<default_policy, signature, cat_self, types<const Cat&>>;
+    BOOST_TEST(cat_self_thunk::address() == (void*)cat_self_thunk::fn);
+}
+
+// A non-virtual parameter whose cast goes through a virtual base. Registering
+// the definition must not touch the (non-existent) object.
+
+struct Thing {
+    virtual ~Thing() {}
+};
+
+using thunk_policy = test_policy_<__COUNTER__>;
+
+use_classes<Thing, thunk_policy> YOMM2_GENSYM;
+
+using poke = method<
+    struct poke_, const void*(virtual_<Thing&>, Mammal&, int), thunk_policy>;
+
+const void* poke_thing(Thing&, Animal& animal, int) {
+    return &animal;
+}
+
+poke::add_function<poke_thing> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(thunk_virtual_base) {
+    update<thunk_policy>();
+
+    Thing thing;
+    Dog dog;
+    Mammal& mammal = dog;
+    BOOST_TEST(poke::fn(thing, mammal, 0) == static_cast<Animal*>(&dog));
+}
+
 } // namespace casts
 
 namespace test_use_classes {
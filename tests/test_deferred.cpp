@@ -0,0 +1,129 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+using test_policy = test_policy_<__COUNTER__>;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Bulldog : Dog {};
+struct Cat : Animal {};
+
+use_classes<Animal, Dog, Bulldog, Cat, test_policy> YOMM2_GENSYM;
+
+struct name_;
+using name = method<name_, string(virtual_<Animal&>), test_policy>;
+
+string name_animal(Animal&) {
+    return "animal";
+}
+
+name::add_function<name_animal> YOMM2_GENSYM;
+
+struct meet_;
+using meet = method<
+    meet_, string(virtual_<Animal&>, virtual_<Animal&>), test_policy>;
+
+string meet_animals(Animal&, Animal&) {
+    return "ignore";
+}
+
+// calls the deferred definition via 'next'
+meet::next_type meet_bulldog_cat_next;
+
+string meet_bulldog_cat(Bulldog& a, Cat& b) {
+    return "growl, then " + meet_bulldog_cat_next(a, b);
+}
+
+meet::add_function<meet_animals> YOMM2_GENSYM;
+meet::add_function<meet_bulldog_cat> YOMM2_GENSYM(&meet_bulldog_cat_next);
+
+// These would be in a shared library, loaded by the loaders, and looked up
+// with dlsym.
+namespace library {
+
+string name_dog(Dog&) {
+    return "dog";
+}
+
+string meet_dog_cat(Dog&, Cat&) {
+    return "chase";
+}
+
+} // namespace library
+
+int name_loads, meet_loads;
+
+name::function_pointer_type load_name_dog() {
+    ++name_loads;
+    return name::thunk<library::name_dog>();
+}
+
+meet::function_pointer_type load_meet_dog_cat() {
+    ++meet_loads;
+    return meet::thunk<library::meet_dog_cat>();
+}
+
+name::add_deferred_function<string(Dog&), load_name_dog> YOMM2_GENSYM;
+meet::add_deferred_function<string(Dog&, Cat&), load_meet_dog_cat>
+    YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_deferred_definitions) {
+    update<test_policy>();
+
+    Animal animal;
+    Dog dog;
+    Bulldog bulldog;
+    Cat cat;
+
+    BOOST_TEST(name::fn(animal) == "animal");
+    BOOST_TEST(meet::fn(cat, dog) == "ignore");
+    BOOST_TEST(name_loads == 0);
+    BOOST_TEST(meet_loads == 0);
+
+    // first call: load
+    BOOST_TEST(name::fn(dog) == "dog");
+    BOOST_TEST(name_loads == 1);
+    BOOST_TEST(name::fn(bulldog) == "dog");
+    BOOST_TEST(name_loads == 1);
+
+    // via 'next', then directly
+    BOOST_TEST(meet::fn(bulldog, cat) == "growl, then chase");
+    BOOST_TEST(meet_loads == 1);
+    BOOST_TEST(meet::fn(dog, cat) == "chase");
+    BOOST_TEST(meet_loads == 1);
+
+    // the stubs stay in place until the next update
+    BOOST_TEST(
+        name::fn.resolve(dog) != name::thunk<library::name_dog>());
+    BOOST_TEST(
+        meet::fn.resolve(dog, cat) != meet::thunk<library::meet_dog_cat>());
+
+    // not loaded again after update, which installs the loaded functions
+    update<test_policy>();
+    BOOST_TEST(
+        name::fn.resolve(dog) == name::thunk<library::name_dog>());
+    BOOST_TEST(
+        meet::fn.resolve(dog, cat) == meet::thunk<library::meet_dog_cat>());
+    BOOST_TEST(name::fn(dog) == "dog");
+    BOOST_TEST(meet::fn(bulldog, cat) == "growl, then chase");
+    BOOST_TEST(name_loads == 1);
+    BOOST_TEST(meet_loads == 1);
+}
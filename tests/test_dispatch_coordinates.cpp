@@ -0,0 +1,152 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <set>
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Bulldog : Dog {};
+struct Cat : Animal {};
+
+template<class Policy>
+struct meet_;
+
+template<class Policy>
+using meet = method<
+    meet_<Policy>, string(virtual_<Animal&>, virtual_<Animal&>), Policy>;
+
+template<class Policy>
+struct first_;
+
+// dispatch depends only on the first argument, and is simplified by update()
+template<class Policy>
+using first = method<
+    first_<Policy>, string(virtual_<Animal&>, virtual_<Animal&>), Policy>;
+
+template<class Policy>
+struct animals {
+    static inline use_classes<Animal, Dog, Bulldog, Cat, Policy> classes;
+
+    static string ignore(Animal&, Animal&) {
+        return "ignore";
+    }
+
+    static string chase(Dog&, Cat&) {
+        return "chase";
+    }
+
+    static string run(Cat&, Dog&) {
+        return "run";
+    }
+
+    static string dog(Dog&, Animal&) {
+        return "dog";
+    }
+
+    static inline typename meet<Policy>::template add_functions<
+        ignore, chase, run>
+        meet_definitions;
+
+    static inline typename first<Policy>::template add_functions<ignore, dog>
+        first_definitions;
+
+    static void use() {
+        (void)&classes;
+        (void)&meet_definitions;
+        (void)&first_definitions;
+    }
+};
+
+struct debug_policy : policy::debug::rebind<debug_policy> {};
+
+struct release_policy : policy::release::rebind<release_policy> {};
+
+struct morton_policy : policy::release::rebind<morton_policy>,
+                       policy::morton_order {};
+
+struct packed_policy : policy::release::rebind<packed_policy>,
+                       policy::packed_slots {};
+
+template<class Policy>
+void check() {
+    animals<Policy>::use();
+    update<Policy>();
+
+    Animal animal;
+    Dog dog;
+    Bulldog bulldog;
+    Cat cat;
+
+    Animal* objects[] = {&animal, &dog, &bulldog, &cat};
+    std::set<std::size_t> cells;
+
+    for (auto a : objects) {
+        for (auto b : objects) {
+            auto cell = meet<Policy>::fn.cell_of(*a, *b);
+            cells.insert(cell);
+            BOOST_TEST(
+                meet<Policy>::fn.target_of(cell) ==
+                meet<Policy>::fn.resolve(*a, *b));
+            BOOST_TEST(
+                meet<Policy>::fn.target_of(cell)(*a, *b) ==
+                meet<Policy>::fn(*a, *b));
+
+            cell = first<Policy>::fn.cell_of(*a, *b);
+            BOOST_TEST(
+                first<Policy>::fn.target_of(cell)(*a, *b) ==
+                first<Policy>::fn(*a, *b));
+        }
+    }
+
+    // Dog and Bulldog are in the same group in both dimensions.
+    BOOST_TEST(
+        meet<Policy>::fn.cell_of(dog, cat) ==
+        meet<Policy>::fn.cell_of(bulldog, cat));
+    BOOST_TEST(
+        meet<Policy>::fn.cell_of(cat, dog) ==
+        meet<Policy>::fn.cell_of(cat, bulldog));
+    BOOST_TEST(
+        meet<Policy>::fn.cell_of(dog, cat) !=
+        meet<Policy>::fn.cell_of(cat, dog));
+
+    // groups: {Animal}, {Dog, Bulldog}, {Cat} in both dimensions
+    BOOST_TEST(cells.size() == 9u);
+
+    if constexpr (Policy::template has_facet<policy::morton_order>) {
+        // padded to 4 x 4
+        BOOST_TEST(*cells.rbegin() < 16u);
+    } else {
+        BOOST_TEST(*cells.rbegin() == 8u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_dispatch_coordinates_debug) {
+    check<debug_policy>();
+}
+
+BOOST_AUTO_TEST_CASE(test_dispatch_coordinates_release) {
+    check<release_policy>();
+}
+
+BOOST_AUTO_TEST_CASE(test_dispatch_coordinates_morton_order) {
+    check<morton_policy>();
+}
+
+BOOST_AUTO_TEST_CASE(test_dispatch_coordinates_packed_slots) {
+    check<packed_policy>();
+}
@@ -0,0 +1,268 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+enum class opcode { add, sub, mul, div, nop };
+
+struct operand {
+    virtual ~operand() {
+    }
+};
+
+struct integer : operand {};
+struct real : operand {};
+
+namespace uni_method {
+
+using test_policy = test_policy_<__COUNTER__>;
+
+use_classes<
+    enum_values<opcode, opcode::add, opcode::sub, opcode::mul>, test_policy>
+    YOMM2_GENSYM;
+
+using mnemonic =
+    method<void, string(virtual_<enum_tag<opcode>>), test_policy>;
+
+string mnemonic_any(enum_tag<opcode> tag) {
+    return "op" + std::to_string(int(tag.value));
+}
+
+string mnemonic_add(enum_value<opcode, opcode::add>) {
+    return "add";
+}
+
+string mnemonic_sub(const enum_value<opcode, opcode::sub>&) {
+    return "sub";
+}
+
+mnemonic::add_function<mnemonic_any> YOMM2_GENSYM;
+mnemonic::add_function<mnemonic_add> YOMM2_GENSYM;
+mnemonic::add_function<mnemonic_sub> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_enum_tag_uni_method) {
+    update<test_policy>();
+
+    BOOST_TEST(mnemonic::fn(opcode::add) == "add");
+    BOOST_TEST(mnemonic::fn(opcode::sub) == "sub");
+    // registered, but no specific definition
+    BOOST_TEST(mnemonic::fn(opcode::mul) == "op2");
+    // in range, but not registered
+    BOOST_TEST(mnemonic::fn(opcode::div) == "op3");
+    // out of range of the registered values
+    BOOST_TEST(mnemonic::fn(opcode::nop) == "op4");
+}
+
+} // namespace uni_method
+
+namespace multi_method {
+
+using test_policy = test_policy_<__COUNTER__>;
+
+use_classes<operand, integer, real, test_policy> YOMM2_GENSYM;
+use_classes<enum_values<opcode, opcode::add, opcode::mul>, test_policy>
+    YOMM2_GENSYM;
+
+using apply = method<
+    void, string(virtual_<enum_tag<opcode>>, virtual_<const operand&>),
+    test_policy>;
+
+string apply_any(enum_tag<opcode>, const operand&) {
+    return "generic";
+}
+
+string apply_add_integer(enum_value<opcode, opcode::add>, const integer&) {
+    return "add integer";
+}
+
+string apply_mul(enum_value<opcode, opcode::mul> tag, const operand&) {
+    return "mul " + std::to_string(int(tag.value));
+}
+
+struct apply_add_real {
+    static string fn(enum_value<opcode, opcode::add> tag, const real& x) {
+        return "add real, then " + next(tag, x);
+    }
+
+    static apply::next_type next;
+};
+
+apply::next_type apply_add_real::next;
+
+apply::add_function<apply_any> YOMM2_GENSYM;
+apply::add_function<apply_add_integer> YOMM2_GENSYM;
+apply::add_function<apply_mul> YOMM2_GENSYM;
+apply::add_definition<apply_add_real> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_enum_tag_multi_method) {
+    update<test_policy>();
+
+    integer i;
+    real r;
+
+    BOOST_TEST(apply::fn(opcode::add, i) == "add integer");
+    BOOST_TEST(apply::fn(opcode::add, r) == "add real, then generic");
+    BOOST_TEST(apply::fn(opcode::mul, i) == "mul 2");
+    BOOST_TEST(apply::fn(opcode::mul, r) == "mul 2");
+    BOOST_TEST(apply::fn(opcode::sub, i) == "generic");
+}
+
+} // namespace multi_method
+
+namespace integral_tags {
+
+using test_policy = test_policy_<__COUNTER__>;
+
+use_classes<enum_values<int, 0, 1, 2>, test_policy> YOMM2_GENSYM;
+
+using arity = method<void, int(virtual_<enum_tag<int>>), test_policy>;
+
+int arity_any(enum_tag<int>) {
+    return -1;
+}
+
+int arity_zero(enum_value<int, 0>) {
+    return 0;
+}
+
+int arity_two(enum_value<int, 2>) {
+    return 2;
+}
+
+arity::add_functions<arity_any, arity_zero, arity_two> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_enum_tag_integral) {
+    update<test_policy>();
+
+    BOOST_TEST(arity::fn(0) == 0);
+    BOOST_TEST(arity::fn(1) == -1);
+    BOOST_TEST(arity::fn(2) == 2);
+    BOOST_TEST(arity::fn(100) == -1);
+}
+
+} // namespace integral_tags
+
+namespace sparse_values {
+
+using test_policy = test_policy_<__COUNTER__>;
+
+// Would be rejected if the value was converted to a signed type.
+enum class status : std::uint32_t { ok = 0, busy = 0xFFFFFFF0 };
+
+use_classes<
+    enum_values<status, status::ok, status::busy>,
+    enum_values<long, 3, 1'000'000, 1'000'000'000>, test_policy>
+    YOMM2_GENSYM;
+
+using describe = method<void, string(virtual_<enum_tag<status>>), test_policy>;
+
+string describe_any(enum_tag<status>) {
+    return "unknown";
+}
+
+string describe_ok(enum_value<status, status::ok>) {
+    return "ok";
+}
+
+string describe_busy(enum_value<status, status::busy>) {
+    return "busy";
+}
+
+describe::add_functions<describe_any, describe_ok, describe_busy>
+    YOMM2_GENSYM;
+
+using scale = method<void, int(virtual_<enum_tag<long>>), test_policy>;
+
+int scale_any(enum_tag<long>) {
+    return -1;
+}
+
+int scale_three(enum_value<long, 3>) {
+    return 3;
+}
+
+int scale_million(enum_value<long, 1'000'000>) {
+    return 6;
+}
+
+int scale_billion(enum_value<long, 1'000'000'000>) {
+    return 9;
+}
+
+scale::add_functions<scale_any, scale_three, scale_million, scale_billion>
+    YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_enum_tag_sparse) {
+    update<test_policy>();
+
+    BOOST_TEST(describe::fn(status::ok) == "ok");
+    BOOST_TEST(describe::fn(status::busy) == "busy");
+    BOOST_TEST(describe::fn(status(42)) == "unknown");
+
+    BOOST_TEST(scale::fn(3) == 3);
+    BOOST_TEST(scale::fn(1'000'000) == 6);
+    BOOST_TEST(scale::fn(1'000'000'000) == 9);
+    BOOST_TEST(scale::fn(999'999) == -1);
+    BOOST_TEST(scale::fn(-1) == -1);
+
+    // large values don't grow the table indexed by value
+    using long_vptrs = detail::enum_vptrs<test_policy, long>;
+    BOOST_TEST(long_vptrs::size == 4u);
+    BOOST_TEST(long_vptrs::sparse_size == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_enum_tag_tables_freed) {
+    enum class local { a, b = 1000 };
+    using vptrs = detail::enum_vptrs<test_policy, local>;
+
+    vptrs::add(local::a, vptrs::default_vptr());
+    vptrs::add(local::b, vptrs::default_vptr());
+    BOOST_TEST(vptrs::vptrs != nullptr);
+    BOOST_TEST(vptrs::sparse != nullptr);
+
+    vptrs::remove(local::b);
+    BOOST_TEST(vptrs::sparse_size == 0u);
+    vptrs::remove(local::a);
+    BOOST_TEST(vptrs::vptrs == nullptr);
+    BOOST_TEST(vptrs::sparse == nullptr);
+    BOOST_TEST(vptrs::size == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_enum_tag_registered_twice) {
+    enum class local { a, b = 1000 };
+    using vptrs = detail::enum_vptrs<test_policy, local>;
+    auto vptr_a = &test_policy::static_vptr<enum_value<local, local::a>>;
+    auto vptr_b = &test_policy::static_vptr<enum_value<local, local::b>>;
+
+    // e.g. by a program and a plugin
+    for (int i = 0; i < 2; ++i) {
+        vptrs::add(local::a, vptr_a);
+        vptrs::add(local::b, vptr_b);
+    }
+
+    // e.g. the plugin is unloaded
+    vptrs::remove(local::a);
+    vptrs::remove(local::b);
+    BOOST_TEST(vptrs::vptrs[0].vptr == vptr_a);
+    BOOST_TEST(vptrs::sparse_size == 1u);
+    BOOST_TEST(vptrs::sparse[0].vptr == vptr_b);
+
+    vptrs::remove(local::a);
+    vptrs::remove(local::b);
+    BOOST_TEST(vptrs::vptrs == nullptr);
+    BOOST_TEST(vptrs::sparse == nullptr);
+}
+
+} // namespace sparse_values
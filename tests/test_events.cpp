@@ -0,0 +1,116 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+struct string_stream {
+    string str;
+};
+
+string_stream& operator<<(string_stream& stream, std::string_view view) {
+    stream.str += view;
+    return stream;
+}
+
+struct test_policy : policy::release::rebind<test_policy>,
+                     policy::basic_event_output<test_policy, string_stream> {
+};
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Cat : Animal {};
+
+use_classes<Animal, Dog, Cat, test_policy> YOMM2_GENSYM;
+
+struct meet_;
+using meet = method<
+    meet_, string(virtual_<Animal&>, virtual_<Animal&>), test_policy>;
+
+string meet_animals(Animal&, Animal&) {
+    return "ignore";
+}
+
+string meet_dog_cat(Dog&, Cat&) {
+    return "chase";
+}
+
+meet::add_functions<meet_animals, meet_dog_cat> YOMM2_GENSYM;
+
+std::vector<string> lines(const string& str) {
+    std::vector<string> result;
+    std::istringstream is(str);
+
+    for (string line; std::getline(is, line);) {
+        result.push_back(line);
+    }
+
+    return result;
+}
+
+bool starts_with(const string& str, const string& prefix) {
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::size_t count(const std::vector<string>& lines, const string& prefix) {
+    return std::count_if(
+        lines.begin(), lines.end(),
+        [&prefix](auto& line) { return starts_with(line, prefix); });
+}
+
+BOOST_AUTO_TEST_CASE(test_events) {
+    test_policy::event_stream.str.clear();
+    auto report = update<test_policy>().report;
+    auto events = lines(test_policy::event_stream.str);
+
+    BOOST_TEST_REQUIRE(!events.empty());
+
+    for (auto& event : events) {
+        BOOST_TEST(starts_with(event, "{\"event\":\""));
+        BOOST_TEST(event.back() == '}');
+    }
+
+    // each type is named once, before it is referred to
+    BOOST_TEST(starts_with(events[0], "{\"event\":\"type\",\"id\":0,"));
+    // 3 classes, 1 method, 2 definitions
+    BOOST_TEST(count(events, "{\"event\":\"type\",") == 6u);
+    BOOST_TEST(count(events, "{\"event\":\"class\",") == 3u);
+    BOOST_TEST(count(events, "{\"event\":\"method\",") == 1u);
+    BOOST_TEST(count(events, "{\"event\":\"definition\",") == 2u);
+    BOOST_TEST(count(events, "{\"event\":\"next\",") == 2u);
+    BOOST_TEST(
+        events.back() ==
+        "{\"event\":\"update\",\"cells\":4,\"concrete_cells\":4,"
+        "\"not_implemented\":0,\"concrete_not_implemented\":0,"
+        "\"ambiguous\":0,\"concrete_ambiguous\":0,\"simplified_methods\":0,"
+        "\"allocations\":" +
+            std::to_string(report.allocations) +
+            ",\"allocated_bytes\":" +
+            std::to_string(report.allocated_bytes) +
+            "}");
+
+    BOOST_TEST(
+        count(events, "{\"event\":\"table\",\"method\":0,\"cells\":[") == 1u);
+
+    test_policy::events_enabled = false;
+    test_policy::event_stream.str.clear();
+    update<test_policy>();
+    BOOST_TEST(test_policy::event_stream.str.empty());
+}
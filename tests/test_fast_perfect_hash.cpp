@@ -0,0 +1,114 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <optional>
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Cat : Animal {};
+
+// "loaded" later
+struct Plant {
+    virtual ~Plant() {
+    }
+};
+
+struct Tree : Plant {};
+struct Flower : Plant {};
+
+using test_policy = test_policy_<__COUNTER__>;
+
+use_classes<Animal, Dog, Cat, test_policy> YOMM2_GENSYM;
+
+struct name_;
+using name = method<name_, string(virtual_<Animal&>), test_policy>;
+
+string name_animal(Animal&) {
+    return "animal";
+}
+
+string name_dog(Dog&) {
+    return "dog";
+}
+
+name::add_functions<name_animal, name_dog> YOMM2_GENSYM;
+
+// Simulates a dynamic library. Must have static storage, because registration
+// relies on zero-initialized links.
+std::optional<use_classes<Plant, Tree, Flower, test_policy>> plugin;
+
+template<class Class>
+auto index() {
+    return test_policy::hash_type_id(test_policy::static_type<Class>());
+}
+
+BOOST_AUTO_TEST_CASE(test_hash_factors_are_reused) {
+    plugin.emplace();
+    update<test_policy>();
+
+    auto mult = test_policy::hash_mult;
+    auto animal_index = index<Animal>();
+    auto dog_index = index<Dog>();
+    auto cat_index = index<Cat>();
+    auto tree_index = index<Tree>();
+
+    // unload the plugin: fewer types, no collisions
+    plugin.reset();
+    update<test_policy>();
+
+    BOOST_TEST(test_policy::hash_mult == mult);
+    BOOST_TEST(index<Animal>() == animal_index);
+    BOOST_TEST(index<Dog>() == dog_index);
+    BOOST_TEST(index<Cat>() == cat_index);
+
+    Dog dog;
+    Cat cat;
+    BOOST_TEST(name::fn(dog) == "dog");
+    BOOST_TEST(name::fn(cat) == "animal");
+
+    // reload it
+    plugin.emplace();
+    update<test_policy>();
+
+    BOOST_TEST(test_policy::hash_mult == mult);
+    BOOST_TEST(index<Animal>() == animal_index);
+    BOOST_TEST(index<Dog>() == dog_index);
+    BOOST_TEST(index<Cat>() == cat_index);
+    BOOST_TEST(index<Tree>() == tree_index);
+    BOOST_TEST(name::fn(dog) == "dog");
+    BOOST_TEST(name::fn(cat) == "animal");
+
+    plugin.reset();
+}
+
+BOOST_AUTO_TEST_CASE(test_hash_search_after_collision) {
+    // Force a collision: all the type ids hash to 0 or 1.
+    test_policy::hash_mult = 1;
+    test_policy::hash_shift = 8 * sizeof(type_id) - 1;
+
+    update<test_policy>();
+
+    BOOST_TEST(test_policy::hash_mult != 1);
+
+    Dog dog;
+    Cat cat;
+    BOOST_TEST(name::fn(dog) == "dog");
+    BOOST_TEST(name::fn(cat) == "animal");
+}
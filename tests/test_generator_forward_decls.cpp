@@ -229,3 +229,65 @@ template<> struct yorel::yomm2::detail::static_offsets<yorel::yomm2::method<baz_
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE(test_generator_scan_names) {
+    std::ostringstream os;
+    os << "\n";
+    generator gen;
+    gen.add_forward_declaration(
+        "ns1::baz<ns2::foo, 3> (*)(ns1::foo&, baz <int>, _hidden, std::string, "
+        "unsigned long)");
+    gen.write_forward_declarations(os);
+    std::string_view expected = R"(
+namespace ns1 {
+class foo;
+}
+namespace ns2 {
+class foo;
+}
+)";
+    BOOST_TEST(os.str() == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_generator_output_file) {
+    const std::string path = "test_generator_output_file.hpp";
+    std::remove(path.c_str());
+
+    auto read = [&path]() {
+        std::ifstream is(path);
+        std::ostringstream os;
+        os << is.rdbuf();
+        return os.str();
+    };
+
+    {
+        generator::output_file file(path);
+        file << "class foo;\n";
+        BOOST_TEST(file.close());
+        BOOST_TEST(file.written);
+        BOOST_TEST(file.close()); // already closed, same result
+    }
+
+    auto content = read();
+    BOOST_TEST(content.substr(0, 2) == "//");
+    BOOST_TEST(content.substr(content.find('\n') + 1) == "class foo;\n");
+
+    {
+        generator::output_file file(path);
+        file << "class foo;\n";
+        BOOST_TEST(!file.close());
+    }
+
+    BOOST_TEST(read() == content);
+
+    {
+        // written by the destructor
+        generator::output_file file(path);
+        file << "class bar;\n";
+    }
+
+    content = read();
+    BOOST_TEST(content.substr(content.find('\n') + 1) == "class bar;\n");
+
+    std::remove(path.c_str());
+}
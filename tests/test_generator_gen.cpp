@@ -14,14 +14,23 @@ int main(int argc, char* argv[]) {
     auto compiler = update<throw_policy>();
     generator generator;
 
-    std::ofstream slots("test_generator_slots.hpp");
+    generator::output_file slots("test_generator_slots.hpp");
 #ifndef _MSC_VER
     generator.add_forward_declarations().write_forward_declarations(slots);
 #endif
     generator.write_static_offsets(slots);
 
-    std::ofstream tables("test_generator_tables.hpp");
+    generator::output_file tables("test_generator_tables.hpp");
     generator.encode_dispatch_data(compiler, tables);
 
+    for (auto file : {&slots, &tables}) {
+        file->close();
+        std::cout << file->path << ": "
+                  << (file->written ? "written" : "unchanged") << " in "
+                  << std::chrono::duration<double, std::milli>(file->elapsed)
+                         .count()
+                  << " ms\n";
+    }
+
     return 0;
 }
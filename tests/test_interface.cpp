@@ -0,0 +1,93 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+using test_policy = test_policy_<__COUNTER__>;
+
+struct Shape {
+    virtual ~Shape() {
+    }
+};
+
+struct Circle : Shape {};
+struct Square : Shape {};
+
+use_classes<Shape, Circle, Square, test_policy> YOMM2_GENSYM;
+
+struct name_;
+using name = method<name_, string(virtual_<const Shape&>), test_policy>;
+
+string name_shape(const Shape&) {
+    return "shape";
+}
+
+string name_circle(const Circle&) {
+    return "circle";
+}
+
+name::add_functions<name_shape, name_circle> YOMM2_GENSYM;
+
+struct scale_;
+using scale = method<
+    scale_, int(int, virtual_ptr<Shape, test_policy>, int), test_policy>;
+
+int scale_shape(int factor, virtual_ptr<Shape, test_policy>, int offset) {
+    return factor + offset;
+}
+
+int scale_square(int factor, virtual_ptr<Square, test_policy>, int offset) {
+    return factor * 10 + offset;
+}
+
+scale::add_functions<scale_shape, scale_square> YOMM2_GENSYM;
+
+struct address_;
+using address =
+    method<address_, const void*(virtual_<const Shape&>), test_policy>;
+
+const void* address_shape(const Shape& shape) {
+    return &shape;
+}
+
+address::add_function<address_shape> YOMM2_GENSYM;
+
+using shape_interface = interface<name, scale, address>;
+
+BOOST_AUTO_TEST_CASE(test_interface) {
+    update<test_policy>();
+
+    Circle circle;
+    Square square;
+
+    shape_interface circle_view(circle);
+    BOOST_TEST(circle_view.get<name>() == name::fn.resolve(circle));
+    BOOST_TEST(circle_view.call<name>() == "circle");
+    BOOST_TEST(circle_view.call<scale>(2, 1) == 3);
+
+    virtual_ptr<Shape, test_policy> square_ptr(square);
+    shape_interface square_view(square_ptr);
+    BOOST_TEST(square_view.call<name>() == "shape");
+    BOOST_TEST(square_view.call<scale>(2, 1) == 21);
+
+    // the object is the one the interface was created for
+    BOOST_TEST(circle_view.call<address>() == static_cast<Shape*>(&circle));
+    BOOST_TEST(square_view.call<address>() == static_cast<Shape*>(&square));
+
+    const Shape& const_square = square;
+    interface<name, address> const_view(const_square);
+    BOOST_TEST(const_view.call<name>() == "shape");
+    BOOST_TEST(const_view.call<address>() == &const_square);
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Bulldog : Dog {};
+struct Cat : Animal {};
+struct Kitten : Cat {};
+struct Bird : Animal {};
+
+template<class Policy>
+struct meet_;
+
+template<class Policy>
+using meet = method<
+    meet_<Policy>, string(virtual_<Animal&>, virtual_<Animal&>), Policy>;
+
+template<class Policy>
+struct fight_;
+
+template<class Policy>
+using fight = method<
+    fight_<Policy>,
+    string(virtual_<Animal&>, virtual_<Animal&>, virtual_<Animal&>), Policy>;
+
+template<class Policy>
+struct animals {
+    static inline use_classes<
+        Animal, Dog, Bulldog, Cat, Kitten, Bird, Policy>
+        classes;
+
+    template<class A, class B>
+    static string meet_animals(A&, B&) {
+        return string(typeid(A).name()) + "/" + typeid(B).name();
+    }
+
+    static inline typename meet<Policy>::template add_functions<
+        meet_animals<Animal, Animal>, meet_animals<Dog, Cat>,
+        meet_animals<Cat, Dog>, meet_animals<Bulldog, Cat>,
+        meet_animals<Bird, Bird>, meet_animals<Dog, Dog>>
+        meet_definitions;
+
+    template<class A, class B, class C>
+    static string fight_animals(A&, B&, C&) {
+        return string(typeid(A).name()) + "/" + typeid(B).name() + "/" +
+            typeid(C).name();
+    }
+
+    static inline typename fight<Policy>::template add_functions<
+        fight_animals<Animal, Animal, Animal>,
+        fight_animals<Dog, Cat, Animal>, fight_animals<Cat, Animal, Bird>,
+        fight_animals<Animal, Bird, Kitten>,
+        fight_animals<Bulldog, Kitten, Bird>>
+        fight_definitions;
+
+    static void use() {
+        (void)&classes;
+        (void)&meet_definitions;
+        (void)&fight_definitions;
+    }
+};
+
+using row_major_policy = test_policy_<__COUNTER__>;
+
+struct morton_policy : test_policy_<__COUNTER__>::rebind<morton_policy>,
+                       policy::morton_order {};
+
+BOOST_AUTO_TEST_CASE(test_morton_order) {
+    animals<row_major_policy>::use();
+    animals<morton_policy>::use();
+
+    update<row_major_policy>();
+    update<morton_policy>();
+
+    Animal animal;
+    Dog dog;
+    Bulldog bulldog;
+    Cat cat;
+    Kitten kitten;
+    Bird bird;
+
+    Animal* objects[] = {&animal, &dog, &bulldog, &cat, &kitten, &bird};
+
+    for (auto a : objects) {
+        for (auto b : objects) {
+            BOOST_TEST(
+                meet<morton_policy>::fn(*a, *b) ==
+                meet<row_major_policy>::fn(*a, *b));
+
+            for (auto c : objects) {
+                BOOST_TEST(
+                    fight<morton_policy>::fn(*a, *b, *c) ==
+                    fight<row_major_policy>::fn(*a, *b, *c));
+            }
+        }
+    }
+
+    // strides are not used, but they are consistent
+    BOOST_TEST(meet<morton_policy>::fn.slots_strides_data()[2] == 1u);
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using namespace yorel::yomm2::policy;
+using std::string;
+
+struct test_policy
+    : basic_policy<
+          test_policy, std_rtti, fast_perfect_hash<test_policy>,
+          vptr_nearest_base<test_policy>, throw_error> {};
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Cat : Animal {};
+
+struct Pet {
+    virtual ~Pet() {
+    }
+};
+
+struct Robot {
+    virtual ~Robot() {
+    }
+};
+
+struct Alien {
+    virtual ~Alien() {
+    }
+};
+
+// Robot is registered, but it is not an Animal.
+use_classes<Animal, Dog, Cat, test_policy> YOMM2_GENSYM;
+use_classes<Robot, test_policy> YOMM2_GENSYM;
+
+// not registered
+struct Puppy : Dog {};           // single inheritance
+struct Bulldog : Puppy {};       // two levels
+struct Kitten : Pet, Cat {};     // multiple inheritance
+struct RoboDog : Robot, Dog {};  // multiple inheritance
+struct Stray : Animal {};        // only the root is registered
+
+struct name_;
+using name = method<name_, string(virtual_<Animal&>), test_policy>;
+
+string name_animal(Animal&) {
+    return "animal";
+}
+
+string name_dog(Dog&) {
+    return "dog";
+}
+
+string name_cat(Cat&) {
+    return "cat";
+}
+
+name::add_functions<name_animal, name_dog, name_cat> YOMM2_GENSYM;
+
+struct meet_;
+using meet = method<
+    meet_, string(virtual_<Animal&>, virtual_<Animal&>), test_policy>;
+
+string meet_animals(Animal&, Animal&) {
+    return "ignore";
+}
+
+string meet_dog_cat(Dog&, Cat&) {
+    return "chase";
+}
+
+meet::add_functions<meet_animals, meet_dog_cat> YOMM2_GENSYM;
+
+struct power_;
+using power = method<power_, string(virtual_<Robot&>), test_policy>;
+
+string power_robot(Robot&) {
+    return "battery";
+}
+
+power::add_function<power_robot> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_nearest_base) {
+    update<test_policy>();
+
+    Puppy puppy;
+    Bulldog bulldog;
+    Kitten kitten;
+    RoboDog robodog;
+    Stray stray;
+
+    // twice: first lookup, then from the cache
+    for (int i = 0; i < 2; ++i) {
+        BOOST_TEST(name::fn(puppy) == "dog");
+        BOOST_TEST(name::fn(bulldog) == "dog");
+        BOOST_TEST(name::fn(kitten) == "cat");
+        BOOST_TEST(name::fn(robodog) == "dog");
+        BOOST_TEST(name::fn(stray) == "animal");
+        BOOST_TEST(meet::fn(bulldog, kitten) == "chase");
+        BOOST_TEST(meet::fn(kitten, bulldog) == "ignore");
+
+        // same dynamic type, different static types
+        BOOST_TEST(power::fn(robodog) == "battery");
+        BOOST_TEST(meet::fn(robodog, kitten) == "chase");
+    }
+
+    virtual_ptr<Robot, test_policy> robot(robodog);
+    BOOST_TEST(robot._vptr() == test_policy::static_vptr<Robot>);
+    virtual_ptr<Animal, test_policy> dog(robodog);
+    BOOST_TEST(dog._vptr() == test_policy::static_vptr<Dog>);
+
+    virtual_ptr<Animal, test_policy> vp(bulldog);
+    BOOST_TEST(vp._vptr() == test_policy::static_vptr<Dog>);
+
+    // the cache is reset by update
+    update<test_policy>();
+    BOOST_TEST(name::fn(bulldog) == "dog");
+}
+
+BOOST_AUTO_TEST_CASE(test_nearest_base_not_found) {
+    update<test_policy>();
+
+    // neither Alien nor its bases are registered
+    BOOST_CHECK_THROW(
+        test_policy::type_vptr(
+            test_policy::static_type<Alien>(),
+            test_policy::static_type<Alien>()),
+        unknown_class_error);
+}
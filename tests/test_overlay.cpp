@@ -0,0 +1,177 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <thread>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using namespace yorel::yomm2::policy;
+using std::string;
+
+struct test_policy
+    : basic_policy<
+          test_policy, std_rtti, checked_perfect_hash<test_policy>,
+          vptr_vector<test_policy>, basic_error_output<test_policy>,
+          basic_overlay<test_policy>> {};
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Cat : Animal {};
+
+use_classes<Animal, Dog, Cat, test_policy> YOMM2_GENSYM;
+
+struct polite {};
+struct loud {};
+struct unused {};
+
+struct greet_;
+using greet = method<greet_, string(virtual_<Animal&>), test_policy>;
+
+string greet_animal(Animal&) {
+    return "hello";
+}
+
+string greet_dog(Dog&) {
+    return "woof";
+}
+
+string greet_dog_politely(Dog&) {
+    return "good day";
+}
+
+string greet_animal_loudly(Animal&) {
+    return "HELLO";
+}
+
+greet::add_functions<greet_animal, greet_dog> YOMM2_GENSYM;
+greet::add_overlay_function<polite, greet_dog_politely> YOMM2_GENSYM;
+greet::add_overlay_function<loud, greet_animal_loudly> YOMM2_GENSYM;
+
+struct meet_;
+using meet = method<
+    meet_, string(virtual_<Animal&>, virtual_<Animal&>), test_policy>;
+
+string meet_animals(Animal&, Animal&) {
+    return "ignore";
+}
+
+string meet_dog_cat(Dog&, Cat&) {
+    return "chase";
+}
+
+string meet_dog_cat_politely(Dog&, Cat&) {
+    return "greet";
+}
+
+string meet_cat_dog_politely(Cat&, Dog&) {
+    return "run";
+}
+
+meet::next_type meet_dogs_next;
+
+string meet_dogs_politely(Dog& a, Dog& b) {
+    return "sniff, then " + meet_dogs_next(a, b);
+}
+
+meet::add_functions<meet_animals, meet_dog_cat> YOMM2_GENSYM;
+meet::add_overlay_functions<
+    polite, meet_dog_cat_politely, meet_cat_dog_politely>
+    YOMM2_GENSYM;
+meet::add_overlay_function<polite, meet_dogs_politely> YOMM2_GENSYM(
+    &meet_dogs_next);
+
+struct name_;
+using name =
+    method<name_, string(virtual_ptr<Animal, test_policy>), test_policy>;
+
+string name_animal(virtual_ptr<Animal, test_policy>) {
+    return "animal";
+}
+
+string name_dog_politely(virtual_ptr<Dog, test_policy>) {
+    return "Sir Dog";
+}
+
+name::add_function<name_animal> YOMM2_GENSYM;
+name::add_overlay_function<polite, name_dog_politely> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_overlay) {
+    update<test_policy>();
+
+    Dog dog;
+    Cat cat;
+    virtual_ptr<Animal, test_policy> vdog(dog);
+
+    BOOST_TEST(greet::fn(dog) == "woof");
+    BOOST_TEST(greet::fn(cat) == "hello");
+    BOOST_TEST(meet::fn(dog, cat) == "chase");
+    BOOST_TEST(meet::fn(cat, dog) == "ignore");
+    BOOST_TEST(meet::fn(dog, dog) == "ignore");
+    BOOST_TEST(name::fn(vdog) == "animal");
+
+    {
+        overlay_scope<polite, test_policy> _;
+
+        // overridden
+        BOOST_TEST(greet::fn(dog) == "good day");
+        BOOST_TEST(meet::fn(dog, cat) == "greet");
+        // added
+        BOOST_TEST(meet::fn(cat, dog) == "run");
+        BOOST_TEST(meet::fn(dog, dog) == "sniff, then ignore");
+        BOOST_TEST(name::fn(vdog) == "Sir Dog");
+        // inherited from the regular definitions
+        BOOST_TEST(greet::fn(cat) == "hello");
+        BOOST_TEST(meet::fn(cat, cat) == "ignore");
+
+        {
+            overlay_scope<loud, test_policy> _;
+            BOOST_TEST(greet::fn(dog) == "woof");
+            BOOST_TEST(greet::fn(cat) == "HELLO");
+            BOOST_TEST(meet::fn(cat, dog) == "ignore");
+        }
+
+        BOOST_TEST(greet::fn(dog) == "good day");
+
+        string in_thread;
+
+        std::thread thread([&]() { in_thread = greet::fn(dog); });
+        thread.join();
+
+        BOOST_TEST(in_thread == "woof");
+    }
+
+    {
+        overlay_scope<unused, test_policy> _;
+        BOOST_TEST(greet::fn(dog) == "woof");
+    }
+
+    BOOST_TEST(greet::fn(dog) == "woof");
+    BOOST_TEST(meet::fn(cat, dog) == "ignore");
+}
+
+BOOST_AUTO_TEST_CASE(test_overlay_dispatch_coordinates) {
+    update<test_policy>();
+
+    Dog dog;
+    Cat cat;
+
+    auto cell = meet::fn.cell_of(dog, cat);
+    BOOST_TEST(meet::fn.target_of(cell)(dog, cat) == "chase");
+
+    {
+        overlay_scope<polite, test_policy> _;
+        BOOST_TEST(meet::fn.cell_of(dog, cat) == cell);
+        BOOST_TEST(meet::fn.target_of(cell)(dog, cat) == "greet");
+    }
+}
@@ -0,0 +1,186 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using namespace yorel::yomm2::policy;
+using std::string;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Cat : Animal {};
+
+template<class Policy>
+bool in_dispatch_data(const std::size_t* p) {
+    auto first = reinterpret_cast<const std::size_t*>(
+        Policy::dispatch_data.data());
+    return p >= first && p < first + Policy::dispatch_data.size();
+}
+
+namespace packed {
+
+struct test_policy
+    : basic_policy<
+          test_policy, std_rtti, checked_perfect_hash<test_policy>,
+          vptr_vector<test_policy>, basic_error_output<test_policy>,
+          packed_slots> {};
+
+use_classes<Animal, Dog, Cat, test_policy> YOMM2_GENSYM;
+
+struct name_;
+using name = method<name_, string(virtual_<Animal&>), test_policy>;
+
+string name_animal(Animal&) {
+    return "animal";
+}
+
+string name_dog(Dog&) {
+    return "dog";
+}
+
+name::add_functions<name_animal, name_dog> YOMM2_GENSYM;
+
+struct meet_;
+using meet = method<
+    meet_, string(virtual_<Animal&>, virtual_<Animal&>), test_policy>;
+
+string meet_animals(Animal&, Animal&) {
+    return "ignore";
+}
+
+string meet_dog_cat(Dog&, Cat&) {
+    return "chase";
+}
+
+string meet_cat_dog(Cat&, Dog&) {
+    return "run";
+}
+
+meet::add_functions<meet_animals, meet_dog_cat, meet_cat_dog> YOMM2_GENSYM;
+
+struct fight_;
+using fight = method<
+    fight_,
+    string(virtual_<Animal&>, virtual_<Animal&>, virtual_<Animal&>),
+    test_policy>;
+
+string fight_animals(Animal&, Animal&, Animal&) {
+    return "draw";
+}
+
+string fight_dogs(Dog&, Dog&, Animal&) {
+    return "dogs win";
+}
+
+fight::add_functions<fight_animals, fight_dogs> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_packed_slots) {
+    // Run update() twice, to check that the block follows 'dispatch_data' when
+    // it is reallocated.
+    for (int i = 0; i < 2; ++i) {
+        update<test_policy>();
+
+        const std::size_t* first = nullptr;
+        std::size_t count = 0;
+
+        for (auto& m : test_policy::methods) {
+            BOOST_TEST(in_dispatch_data<test_policy>(m.slots_strides_ptr));
+
+            if (!first) {
+                first = m.slots_strides_ptr;
+                BOOST_TEST(reinterpret_cast<std::uintptr_t>(first) % 64 == 0);
+            }
+
+            // blocks are contiguous, in method order
+            BOOST_TEST(m.slots_strides_ptr == first + count);
+            count += 2 * m.arity() - 1;
+        }
+
+        BOOST_TEST(count == 1 + 3 + 5);
+
+        // static arrays are not used
+        BOOST_TEST(name::fn.slots_strides_ptr != name::slots_strides);
+        BOOST_TEST(meet::fn.slots_strides_ptr != meet::slots_strides);
+
+        Animal animal;
+        Dog dog;
+        Cat cat;
+
+        BOOST_TEST(name::fn(animal) == "animal");
+        BOOST_TEST(name::fn(dog) == "dog");
+        BOOST_TEST(name::fn(cat) == "animal");
+
+        BOOST_TEST(meet::fn(dog, cat) == "chase");
+        BOOST_TEST(meet::fn(cat, dog) == "run");
+        BOOST_TEST(meet::fn(dog, dog) == "ignore");
+
+        BOOST_TEST(fight::fn(dog, dog, cat) == "dogs win");
+        BOOST_TEST(fight::fn(dog, cat, dog) == "draw");
+    }
+}
+
+} // namespace packed
+
+namespace packed_overlay {
+
+struct test_policy
+    : basic_policy<
+          test_policy, std_rtti, checked_perfect_hash<test_policy>,
+          vptr_vector<test_policy>, basic_error_output<test_policy>,
+          basic_overlay<test_policy>, packed_slots> {};
+
+use_classes<Animal, Dog, Cat, test_policy> YOMM2_GENSYM;
+
+struct polite {};
+
+struct meet_;
+using meet = method<
+    meet_, string(virtual_<Animal&>, virtual_<Animal&>), test_policy>;
+
+string meet_animals(Animal&, Animal&) {
+    return "ignore";
+}
+
+string meet_dog_cat(Dog&, Cat&) {
+    return "chase";
+}
+
+string meet_dog_cat_politely(Dog&, Cat&) {
+    return "greet";
+}
+
+meet::add_functions<meet_animals, meet_dog_cat> YOMM2_GENSYM;
+meet::add_overlay_function<polite, meet_dog_cat_politely> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_packed_slots_with_overlay) {
+    update<test_policy>();
+
+    BOOST_TEST(in_dispatch_data<test_policy>(meet::fn.slots_strides_ptr));
+
+    Dog dog;
+    Cat cat;
+
+    BOOST_TEST(meet::fn(dog, cat) == "chase");
+
+    {
+        overlay_scope<polite, test_policy> _;
+        BOOST_TEST(meet::fn(dog, cat) == "greet");
+        BOOST_TEST(meet::fn(cat, dog) == "ignore");
+    }
+
+    BOOST_TEST(meet::fn(dog, cat) == "chase");
+}
+
+} // namespace packed_overlay
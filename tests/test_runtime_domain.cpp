@@ -0,0 +1,181 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <thread>
+
+#include <yorel/yomm2/keywords.hpp>
+#include <yorel/yomm2/runtime_domain.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Cat : Animal {};
+struct Lion : Cat {};
+struct Fish : Animal {};
+
+using test_policy = test_policy_<__COUNTER__>;
+using domain = runtime_domain<test_policy>;
+
+use_classes<Animal, Dog, Cat, Lion, Fish, test_policy> YOMM2_GENSYM;
+
+struct kick_;
+using kick = method<kick_, string(virtual_<Animal&>), test_policy>;
+
+string kick_animal(Animal&) {
+    return "animal";
+}
+
+string kick_dog(Dog&) {
+    return "bark";
+}
+
+string kick_cat(Cat&) {
+    return "hiss";
+}
+
+string kick_lion(Lion&) {
+    return "roar";
+}
+
+kick::add_functions<kick_animal, kick_dog, kick_cat, kick_lion> YOMM2_GENSYM;
+
+struct meet_;
+using meet = method<
+    meet_, string(virtual_<Animal&>, virtual_<Animal&>), test_policy>;
+
+string meet_animals(Animal&, Animal&) {
+    return "ignore";
+}
+
+string meet_dog_cat(Dog&, Cat&) {
+    return "chase";
+}
+
+string meet_cat_dog(Cat&, Dog&) {
+    return "run";
+}
+
+string meet_lions(Lion&, Lion&) {
+    return "fight";
+}
+
+meet::add_functions<meet_animals, meet_dog_cat, meet_cat_dog, meet_lions>
+    YOMM2_GENSYM;
+
+struct name_;
+using name =
+    method<name_, string(virtual_ptr<Animal, test_policy>), test_policy>;
+
+string name_animal(virtual_ptr<Animal, test_policy>) {
+    return "animal";
+}
+
+string name_cat(virtual_ptr<Cat, test_policy>) {
+    return "cat";
+}
+
+name::add_functions<name_animal, name_cat> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_runtime_domain) {
+    update<test_policy>();
+
+    Dog dog;
+    Cat cat;
+    Lion lion;
+    Fish fish;
+
+    domain dogs;
+    dogs.add_classes<Dog>().add_methods<kick, meet>();
+    dogs.update();
+
+    domain cats;
+    cats.add_classes<Cat, Lion>().add_methods<kick, meet, name>();
+    cats.update();
+
+    domain all;
+    all.add_classes<Dog, Cat, Lion, Fish>().add_methods<kick, meet>();
+    all.update();
+
+    BOOST_TEST(dogs.call<kick>(dog) == "bark");
+    BOOST_TEST(dogs.call<meet>(dog, dog) == "ignore");
+    BOOST_TEST(dogs.resolve<kick>(dog) == kick::fn.resolve(dog));
+
+    BOOST_TEST(cats.call<kick>(cat) == "hiss");
+    BOOST_TEST(cats.call<kick>(lion) == "roar");
+    BOOST_TEST(cats.call<meet>(lion, lion) == "fight");
+    BOOST_TEST(cats.call<meet>(cat, lion) == "ignore");
+
+    BOOST_TEST(all.call<kick>(fish) == "animal");
+    BOOST_TEST(all.call<meet>(dog, cat) == "chase");
+    BOOST_TEST(all.call<meet>(dog, lion) == "chase");
+    BOOST_TEST(all.call<meet>(lion, dog) == "run");
+    BOOST_TEST(all.call<meet>(lion, lion) == "fight");
+
+    // domains contain only the tables for their own classes and methods
+    BOOST_TEST(dogs.dispatch_data().size() < all.dispatch_data().size());
+    BOOST_TEST(
+        all.dispatch_data().size() <= test_policy::dispatch_data.size());
+
+    virtual_ptr<Animal, test_policy> vlion(lion);
+    BOOST_TEST(cats.call<name>(vlion) == "cat");
+}
+
+BOOST_AUTO_TEST_CASE(test_runtime_domain_scope) {
+    update<test_policy>();
+
+    Dog dog;
+    Cat cat;
+
+    domain dogs;
+    dogs.add_classes<Dog>().add_methods<kick>();
+    dogs.update();
+
+    domain cats;
+    cats.add_classes<Cat>().add_methods<kick>();
+    cats.update();
+
+    BOOST_TEST(domain::current() == nullptr);
+    // not bound: dispatch through the static domain
+    BOOST_TEST(call_in_domain<kick>(dog) == "bark");
+
+    {
+        domain::scope _(cats);
+        BOOST_TEST(domain::current() == &cats);
+        BOOST_TEST(call_in_domain<kick>(cat) == "hiss");
+
+        {
+            domain::scope _(dogs);
+            BOOST_TEST(call_in_domain<kick>(dog) == "bark");
+        }
+
+        BOOST_TEST(domain::current() == &cats);
+
+        string in_thread;
+
+        std::thread thread([&]() {
+            domain::scope _(dogs);
+            in_thread = call_in_domain<kick>(dog);
+        });
+
+        thread.join();
+
+        BOOST_TEST(in_thread == "bark");
+        BOOST_TEST(domain::current() == &cats);
+    }
+
+    BOOST_TEST(domain::current() == nullptr);
+}
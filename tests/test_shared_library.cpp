@@ -0,0 +1,56 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Linked against the shared library. The instantiations of 'update' for the
+// shared policies come from the library; see also the
+// test_shared_library_instantiations test in CMakeLists.txt.
+
+#if !defined(YOMM2_SHARED)
+#error "This should be compiled only against the shared library."
+#endif
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Cat : Animal {};
+
+register_classes(Animal, Dog, Cat);
+
+declare_method(string, kick, (virtual_<Animal&>));
+
+define_method(string, kick, (Animal&)) {
+    return "ignore";
+}
+
+define_method(string, kick, (Dog&)) {
+    return "bark";
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_library) {
+    update();
+
+    Dog dog;
+    Cat cat;
+    BOOST_TEST(kick(dog) == "bark");
+    BOOST_TEST(kick(cat) == "ignore");
+
+    // the library contains both instantiations
+    update<policy::debug_shared>();
+    update<policy::release_shared>();
+    BOOST_TEST(kick(dog) == "bark");
+}
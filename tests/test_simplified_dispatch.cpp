@@ -0,0 +1,175 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Dog : Animal {};
+struct Bulldog : Dog {};
+struct Cat : Animal {};
+
+using binary = string(virtual_<Animal&>, virtual_<Animal&>);
+
+template<class Policy>
+struct constant_;
+
+template<class Policy>
+using constant = method<constant_<Policy>, binary, Policy>;
+
+template<class Policy>
+struct first_;
+
+template<class Policy>
+using first = method<first_<Policy>, binary, Policy>;
+
+template<class Policy>
+struct second_;
+
+template<class Policy>
+using second = method<second_<Policy>, binary, Policy>;
+
+template<class Policy>
+struct both_;
+
+template<class Policy>
+using both = method<both_<Policy>, binary, Policy>;
+
+template<class Policy>
+struct third_;
+
+template<class Policy>
+using third = method<
+    third_<Policy>,
+    string(virtual_<Animal&>, virtual_<Animal&>, virtual_<Animal&>), Policy>;
+
+template<class Policy>
+struct animals {
+    static inline use_classes<Animal, Dog, Bulldog, Cat, Policy> classes;
+
+    template<class A, class B>
+    static string name(A&, B&) {
+        return string(typeid(A).name()) + "/" + typeid(B).name();
+    }
+
+    template<class A, class B, class C>
+    static string name(A&, B&, C&) {
+        return string(typeid(A).name()) + "/" + typeid(B).name() + "/" +
+            typeid(C).name();
+    }
+
+    // one definition
+    static inline typename constant<Policy>::template add_functions<
+        name<Animal, Animal>>
+        constant_definitions;
+
+    // three definitions, depending only on the first argument
+    static inline typename first<Policy>::template add_functions<
+        name<Animal, Animal>, name<Dog, Animal>, name<Bulldog, Animal>>
+        first_definitions;
+
+    // a catch-all and a specialization on the second argument
+    static inline typename second<Policy>::template add_functions<
+        name<Animal, Animal>, name<Animal, Cat>>
+        second_definitions;
+
+    // depends on both arguments
+    static inline typename both<Policy>::template add_functions<
+        name<Animal, Animal>, name<Dog, Cat>>
+        both_definitions;
+
+    // depends only on the third argument
+    static inline typename third<Policy>::template add_functions<
+        name<Animal, Animal, Animal>, name<Animal, Animal, Dog>>
+        third_definitions;
+
+    static void use() {
+        (void)&classes;
+        (void)&constant_definitions;
+        (void)&first_definitions;
+        (void)&second_definitions;
+        (void)&both_definitions;
+        (void)&third_definitions;
+    }
+};
+
+// runtime_checks disables the simplifications
+struct reference_policy : policy::debug::rebind<reference_policy> {};
+
+struct row_major_policy : policy::release::rebind<row_major_policy> {};
+
+struct morton_policy : policy::release::rebind<morton_policy>,
+                       policy::morton_order {};
+
+struct packed_policy : policy::release::rebind<packed_policy>,
+                       policy::packed_slots {};
+
+template<class Policy>
+void check() {
+    animals<Policy>::use();
+    animals<reference_policy>::use();
+
+    auto report = update<Policy>().report;
+    BOOST_TEST(report.simplified_methods == 4u);
+    BOOST_TEST(update<reference_policy>().report.simplified_methods == 0u);
+
+    BOOST_TEST(constant<Policy>::fn.decisive_vp == 2u);
+    BOOST_TEST(first<Policy>::fn.decisive_vp == 0u);
+    BOOST_TEST(second<Policy>::fn.decisive_vp == 1u);
+    BOOST_TEST(both<Policy>::fn.decisive_vp == detail::method_info::all_vps);
+    BOOST_TEST(third<Policy>::fn.decisive_vp == 2u);
+
+    Animal animal;
+    Dog dog;
+    Bulldog bulldog;
+    Cat cat;
+
+    Animal* objects[] = {&animal, &dog, &bulldog, &cat};
+
+    for (auto a : objects) {
+        for (auto b : objects) {
+            BOOST_TEST(
+                constant<Policy>::fn(*a, *b) ==
+                constant<reference_policy>::fn(*a, *b));
+            BOOST_TEST(
+                first<Policy>::fn(*a, *b) ==
+                first<reference_policy>::fn(*a, *b));
+            BOOST_TEST(
+                second<Policy>::fn(*a, *b) ==
+                second<reference_policy>::fn(*a, *b));
+            BOOST_TEST(
+                both<Policy>::fn(*a, *b) == both<reference_policy>::fn(*a, *b));
+
+            for (auto c : objects) {
+                BOOST_TEST(
+                    third<Policy>::fn(*a, *b, *c) ==
+                    third<reference_policy>::fn(*a, *b, *c));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_simplified_dispatch_row_major) {
+    check<row_major_policy>();
+}
+
+BOOST_AUTO_TEST_CASE(test_simplified_dispatch_morton_order) {
+    check<morton_policy>();
+}
+
+BOOST_AUTO_TEST_CASE(test_simplified_dispatch_packed_slots) {
+    check<packed_policy>();
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+
+struct Animal {
+    virtual ~Animal() {
+    }
+};
+
+struct Pet {
+    virtual ~Pet() {
+    }
+
+    int name = 0;
+};
+
+struct Dog : Animal, Pet {};
+struct Bulldog : Dog {};
+struct Cat : Animal, Pet {};
+
+using test_policy = test_policy_<__COUNTER__>;
+
+use_classes<Animal, Pet, Dog, Bulldog, Cat, test_policy> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_is_a) {
+    // instantiate the tests before calling update
+    auto test = [](const Animal& a) {
+        return std::make_tuple(
+            is_a<Dog, test_policy>(a), is_a<Bulldog, test_policy>(a),
+            is_a<Cat, test_policy>(a), is_a<Animal, test_policy>(a));
+    };
+
+    update<test_policy>();
+
+    Animal animal;
+    Dog dog;
+    Bulldog bulldog;
+    Cat cat;
+
+    BOOST_TEST((test(animal) == std::make_tuple(false, false, false, true)));
+    BOOST_TEST((test(dog) == std::make_tuple(true, false, false, true)));
+    BOOST_TEST((test(bulldog) == std::make_tuple(true, true, false, true)));
+    BOOST_TEST((test(cat) == std::make_tuple(false, false, true, true)));
+}
+
+BOOST_AUTO_TEST_CASE(test_checked_cast) {
+    auto cast = [](Pet& pet) { return checked_cast<Dog, test_policy>(pet); };
+    auto cast_const = [](const Animal& animal) {
+        return checked_cast<Cat, test_policy>(animal);
+    };
+
+    update<test_policy>();
+
+    Bulldog bulldog;
+    Cat cat;
+
+    // the result is adjusted, as with dynamic_cast
+    Dog* dog = cast(bulldog);
+    BOOST_TEST(dog == static_cast<Dog*>(&bulldog));
+    BOOST_TEST(static_cast<void*>(dog) != static_cast<Pet*>(&bulldog));
+    BOOST_TEST(cast(cat) == nullptr);
+
+    static_assert(
+        std::is_same_v<decltype(cast_const(cat)), const Cat*>,
+        "constness is preserved");
+    BOOST_TEST(cast_const(cat) == &cat);
+    BOOST_TEST(cast_const(bulldog) == nullptr);
+}
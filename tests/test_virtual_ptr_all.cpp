@@ -54,7 +54,19 @@ struct indirect_test_policy : test_policy_<Key> {
 };
 
 template<int Key>
-using policy_types = types<test_policy_<Key>, indirect_test_policy<Key>>;
+struct generation_test_policy
+    : policy::basic_policy<
+          generation_test_policy<Key>, policy::std_rtti,
+          policy::checked_perfect_hash<generation_test_policy<Key>>,
+          policy::vptr_vector<generation_test_policy<Key>>,
+          policy::basic_error_output<generation_test_policy<Key>>,
+          policy::vectored_error<generation_test_policy<Key>>,
+          policy::basic_generation_vptr<generation_test_policy<Key>>> {};
+
+template<int Key>
+using policy_types = types<
+    test_policy_<Key>, indirect_test_policy<Key>,
+    generation_test_policy<Key>>;
 
 namespace YOMM2_GENSYM {
 
@@ -199,3 +211,77 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(
 }
 
 } // namespace test_virtual_shared_ptr_dispatch
+
+namespace test_virtual_unique_ptr {
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+    test_virtual_unique_ptr, Policy, policy_types<__COUNTER__>) {
+
+    static use_classes<Player, Warrior, Object, Axe, Bear, Policy> YOMM2_GENSYM;
+
+    using kick = method<void, std::string(virtual_ptr<Player, Policy>), Policy>;
+    static typename kick::template add_function<
+        kick_bear<virtual_ptr<Player, Policy>>>
+        YOMM2_GENSYM;
+
+    using fight = method<
+        void,
+        std::string(
+            virtual_ptr<Player, Policy>, virtual_ptr<Object, Policy>,
+            virtual_ptr<Player, Policy>),
+        Policy>;
+    static typename fight::template add_function<fight_bear<
+        virtual_ptr<Player, Policy>, virtual_ptr<Object, Policy>,
+        virtual_ptr<Player, Policy>>>
+        YOMM2_GENSYM;
+
+    update<Policy>();
+
+    static_assert(!std::is_copy_constructible_v<
+                  virtual_unique_ptr<Player, Policy>>);
+
+    auto bear = make_virtual_unique<Bear, Policy>();
+    static_assert(std::is_same_v<decltype(bear.get()), Bear*>);
+
+    virtual_unique_ptr<Player, Policy> player(std::move(bear));
+    BOOST_TEST(bear.get() == nullptr);
+    BOOST_TEST(
+        (player._vptr() == Policy::template static_vptr<Bear>));
+
+    virtual_unique_ptr<Player, Policy> warrior(std::make_unique<Warrior>());
+    BOOST_TEST(
+        (warrior._vptr() == Policy::template static_vptr<Warrior>));
+
+    // methods borrow the objects
+    BOOST_TEST(kick::fn(player) == "growl");
+    BOOST_TEST(player.get() != nullptr);
+
+    auto axe = make_virtual_unique<Axe, Policy>();
+    BOOST_TEST(fight::fn(warrior, axe, player) == "kill bear");
+
+    // only lvalues can be borrowed from
+    static_assert(std::is_constructible_v<
+                  virtual_ptr<Player, Policy>,
+                  virtual_unique_ptr<Bear, Policy>&>);
+    static_assert(std::is_constructible_v<
+                  virtual_ptr<Player, Policy>,
+                  const virtual_unique_ptr<Bear, Policy>&>);
+    static_assert(!std::is_constructible_v<
+                  virtual_ptr<Player, Policy>,
+                  virtual_unique_ptr<Bear, Policy>&&>);
+    static_assert(!std::is_constructible_v<
+                  virtual_ptr<Player, Policy>,
+                  const virtual_unique_ptr<Bear, Policy>&&>);
+    static_assert(!std::is_constructible_v<
+                  virtual_ptr<Player, Policy>,
+                  virtual_shared_ptr<Bear, Policy>&&>);
+    static_assert(!std::is_convertible_v<
+                  virtual_unique_ptr<Bear, Policy>, virtual_ptr<Player, Policy>>);
+
+    // owning pointers can still be moved into each other
+    static_assert(std::is_constructible_v<
+                  virtual_unique_ptr<Player, Policy>,
+                  virtual_unique_ptr<Bear, Policy>&&>);
+}
+
+} // namespace test_virtual_unique_ptr
@@ -0,0 +1,143 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <vector>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#include "test_util.hpp"
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using std::string;
+
+using test_policy = test_policy_<__COUNTER__>;
+
+struct Shape {
+    static int instances;
+
+    Shape() {
+        ++instances;
+    }
+
+    Shape(const Shape&) {
+        ++instances;
+    }
+
+    virtual ~Shape() {
+        --instances;
+    }
+};
+
+int Shape::instances;
+
+struct Circle : Shape {
+    double radius;
+
+    Circle(double radius) : radius(radius) {
+    }
+};
+
+struct Label {
+    string text;
+
+    virtual ~Label() {
+    }
+};
+
+// Shape is not the first base: its address is not the object's.
+struct Text : Label, Shape {
+    Text(string text) {
+        this->text = std::move(text);
+    }
+};
+
+use_classes<Shape, Circle, Label, Text, test_policy> YOMM2_GENSYM;
+
+using shape = virtual_value<Shape, 64, alignof(std::max_align_t), test_policy>;
+
+struct describe_;
+using describe = method<describe_, string(const shape&), test_policy>;
+
+string describe_shape(const Shape&) {
+    return "shape";
+}
+
+string describe_circle(const Circle& circle) {
+    return "circle " + std::to_string(int(circle.radius));
+}
+
+string describe_text(const Text& text) {
+    return "text " + text.text;
+}
+
+describe::add_functions<describe_shape, describe_circle, describe_text>
+    YOMM2_GENSYM;
+
+struct grow_;
+using grow = method<grow_, void(shape&), test_policy>;
+
+void grow_circle(Circle& circle) {
+    circle.radius *= 2;
+}
+
+grow::add_function<grow_circle> YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_virtual_value) {
+    update<test_policy>();
+
+    {
+        std::vector<shape> shapes;
+        shapes.emplace_back(Circle(1));
+        shapes.emplace_back(std::in_place_type<Text>, "hello");
+        shapes.push_back(
+            make_virtual_value<
+                Shape, Circle, 64, alignof(std::max_align_t), test_policy>(3));
+
+        BOOST_TEST(shapes[0]._vptr() == test_policy::static_vptr<Circle>);
+        BOOST_TEST(shapes[1]._vptr() == test_policy::static_vptr<Text>);
+
+        // the object is stored inline
+        auto storage = reinterpret_cast<const char*>(&shapes[1]);
+        auto object = reinterpret_cast<const char*>(
+            static_cast<const Label*>(static_cast<const Text*>(shapes[1].get())));
+        BOOST_TEST(object == storage);
+
+        BOOST_TEST(describe::fn(shapes[0]) == "circle 1");
+        BOOST_TEST(describe::fn(shapes[1]) == "text hello");
+        BOOST_TEST(describe::fn(shapes[2]) == "circle 3");
+
+        grow::fn(shapes[0]);
+        BOOST_TEST(describe::fn(shapes[0]) == "circle 2");
+
+        // copy
+        shape copy = shapes[1];
+        BOOST_TEST(describe::fn(copy) == "text hello");
+        BOOST_TEST(copy.get() != shapes[1].get());
+
+        copy = shapes[0];
+        BOOST_TEST(describe::fn(copy) == "circle 2");
+
+        // move
+        shape moved = std::move(copy);
+        BOOST_TEST(describe::fn(moved) == "circle 2");
+
+        moved = std::move(shapes[1]);
+        BOOST_TEST(describe::fn(moved) == "text hello");
+
+        // grow the vector: the values are moved
+        for (int i = 0; i < 16; ++i) {
+            shapes.emplace_back(Circle(i));
+        }
+
+        BOOST_TEST(describe::fn(shapes[0]) == "circle 2");
+        BOOST_TEST(describe::fn(shapes[18]) == "circle 15");
+    }
+
+    BOOST_TEST(Shape::instances == 0);
+}
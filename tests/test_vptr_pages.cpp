@@ -0,0 +1,172 @@
+// Copyright (c) 2018-2024 Jean-Louis Leroy
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <vector>
+
+#include <yorel/yomm2/keywords.hpp>
+
+#define BOOST_TEST_MODULE yomm2
+#include <boost/test/included/unit_test.hpp>
+
+using namespace yorel::yomm2;
+using namespace yorel::yomm2::policy;
+using std::string;
+
+// Not polymorphic: the v-table is found via the page the object lives in.
+struct Number {};
+
+struct Integer : Number {
+    explicit Integer(int value) : value(value) {
+    }
+
+    int value;
+};
+
+struct Rational : Number {
+    Rational(int num, int den) : num(num), den(den) {
+    }
+
+    int num, den;
+};
+
+struct Labeled {
+    int label = 0;
+};
+
+// Number is not the first base: the Number subobject does not start at the
+// address of the object.
+struct LabeledInteger : Labeled, Integer {
+    explicit LabeledInteger(int value) : Integer(value) {
+        label = 1;
+    }
+
+    ~LabeledInteger() {
+        ++destroyed;
+    }
+
+    static int destroyed;
+};
+
+int LabeledInteger::destroyed;
+
+struct Person {
+    virtual ~Person() {
+    }
+};
+
+struct Engineer : Person {};
+
+struct test_policy
+    : basic_policy<
+          test_policy, std_rtti, fast_perfect_hash<test_policy>,
+          vptr_pages<test_policy, Number>> {
+    static constexpr std::size_t vptr_page_size = 256;
+};
+
+use_classes<
+    Number, Integer, Rational, LabeledInteger, Person, Engineer, test_policy>
+    YOMM2_GENSYM;
+
+struct describe_;
+using describe = method<
+    describe_, string(virtual_<const Person&>, virtual_<const Number&>),
+    test_policy>;
+
+string describe_number(const Person&, const Number&) {
+    return "number";
+}
+
+string describe_integer(const Person&, const Integer& i) {
+    return "integer " + std::to_string(i.value);
+}
+
+string describe_rational(const Engineer&, const Rational& r) {
+    return "rational " + std::to_string(r.num) + "/" + std::to_string(r.den);
+}
+
+describe::add_functions<describe_number, describe_integer, describe_rational>
+    YOMM2_GENSYM;
+
+BOOST_AUTO_TEST_CASE(test_vptr_pages) {
+    static_assert(sizeof(Integer) == sizeof(int));
+    static_assert(sizeof(Rational) == 2 * sizeof(int));
+
+    update<test_policy>();
+
+    Person person;
+    Engineer engineer;
+
+    std::vector<Integer*> integers;
+
+    // enough objects to fill several pages
+    for (int i = 0; i < 200; ++i) {
+        integers.push_back(test_policy::new_paged<Integer>(i));
+    }
+
+    auto r = test_policy::new_paged<Rational>(2, 3);
+
+    for (int i = 0; i < 200; ++i) {
+        BOOST_TEST(
+            describe::fn(person, *integers[i]) ==
+            "integer " + std::to_string(i));
+    }
+
+    BOOST_TEST(describe::fn(person, *r) == "number");
+    BOOST_TEST(describe::fn(engineer, *r) == "rational 2/3");
+
+    // v-tables are found after a new update
+    update<test_policy>();
+    BOOST_TEST(describe::fn(engineer, *integers[42]) == "integer 42");
+    BOOST_TEST(describe::fn(engineer, *r) == "rational 2/3");
+
+    // freed objects are recycled for the same class
+    auto freed = integers[7];
+    test_policy::delete_paged(freed);
+    auto recycled = test_policy::new_paged<Integer>(-1);
+    BOOST_TEST(recycled == freed);
+    BOOST_TEST(describe::fn(person, *recycled) == "integer -1");
+
+    for (auto i : integers) {
+        test_policy::delete_paged(i);
+    }
+
+    test_policy::delete_paged(r);
+}
+
+BOOST_AUTO_TEST_CASE(test_vptr_pages_delete_through_base) {
+    update<test_policy>();
+
+    Person person;
+
+    // the slot goes back to the pool of the dynamic class
+    Number* number = test_policy::new_paged<Integer>(1);
+    auto freed = static_cast<void*>(number);
+    test_policy::delete_paged(number);
+
+    auto plain = test_policy::new_paged<Number>();
+    BOOST_TEST(static_cast<void*>(plain) != freed);
+    BOOST_TEST(describe::fn(person, *plain) == "number");
+
+    auto integer = test_policy::new_paged<Integer>(2);
+    BOOST_TEST(static_cast<void*>(integer) == freed);
+    BOOST_TEST(describe::fn(person, *integer) == "integer 2");
+
+    // the pointer does not point to the start of the object
+    auto labeled = test_policy::new_paged<LabeledInteger>(3);
+    Integer* base = labeled;
+    BOOST_TEST(static_cast<void*>(base) != static_cast<void*>(labeled));
+    BOOST_TEST(describe::fn(person, *base) == "integer 3");
+    test_policy::delete_paged(base);
+    BOOST_TEST(LabeledInteger::destroyed == 1);
+
+    auto recycled = test_policy::new_paged<LabeledInteger>(4);
+    BOOST_TEST(recycled == labeled);
+    BOOST_TEST(recycled->label == 1);
+
+    test_policy::delete_paged(recycled);
+    test_policy::delete_paged(integer);
+    test_policy::delete_paged(plain);
+}